@@ -156,6 +156,31 @@ int vector_push(vector* t_vector, const void* t_data)
 	return 1;
 }
 
+int vector_push_many(vector* t_vector, const void* t_data, unsigned int t_count)
+{
+	assert(t_vector);
+	assert(t_data || !t_count);
+	
+	unsigned int capacity = vector_find_capacity(t_vector);
+	if (capacity < t_vector->element_count + t_count)
+	{
+		while (capacity < t_vector->element_count + t_count)
+		{
+			capacity = capacity ? capacity * 2 : 1;
+		}
+		if (!vector_resize(t_vector, capacity))
+		{
+			return 0;
+		}
+	}
+	if (t_count)
+	{
+		memcpy(((char*)t_vector->buffer.data) + t_vector->element_count * t_vector->element_size, t_data, t_count * t_vector->element_size);
+	}
+	t_vector->element_count += t_count;
+	return 1;
+}
+
 void vector_remove(vector* t_vector, unsigned int t_index)
 {
 	assert(t_vector);
@@ -214,7 +239,7 @@ p_link link_list_insert(p_link t_position, void* t_data)
 {
 	assert(t_position);
 
-	p_link link = (p_link)malloc(sizeof(link));
+	p_link link = (p_link)malloc(sizeof(*link));
 
 	link->data = t_data;
 	link->prev = t_position;
@@ -300,7 +325,7 @@ p_hash_pair hash_pair_alloc(const char* t_key, void* t_data)
 {
 	assert(t_key);
 
-	p_hash_pair pair = (p_hash_pair)malloc(sizeof(hash_pair) + strlen(t_key));
+	p_hash_pair pair = (p_hash_pair)malloc(sizeof(hash_pair) + strlen(t_key) + 1);
 	char* key = (char*)(pair + 1);
 	unsigned char hash = hash_string(t_key);
 	strcpy(key, t_key);
@@ -396,7 +421,7 @@ void hash_list_remove(hash_list* t_list, p_link t_link)
 	{
 		p_link next = (p_link)t_link->next;
 		p_hash_pair next_pair = (p_hash_pair)next->data;
-		t_list->buckets[pair->hash] = (next_pair->hash == pair->hash) ? next : t_list->pairs.end;
+		t_list->buckets[pair->hash] = (next != t_list->pairs.end && next_pair->hash == pair->hash) ? next : t_list->pairs.end;
 	}
 	hash_pair_free(pair);
 	link_list_remove(t_link);
@@ -479,7 +504,104 @@ int factory_free(factory* t_factory, void* t_memptr)
 {
 	assert(t_factory && t_memptr);
 	
-	int result = vector_push(&t_factory->free, t_memptr);
+	int result = vector_push(&t_factory->free, &t_memptr);
 	
 	return result;
 }
+
+int arena_init(arena* t_arena, size_t t_chunk_size)
+{
+	assert(t_arena);
+	assert(t_chunk_size);
+	
+	if (!vector_init(&t_arena->chunks, sizeof(void*)))
+	{
+		return 0;
+	}
+	t_arena->chunk_size = t_chunk_size;
+	t_arena->position = 0;
+	t_arena->end = 0;
+	return 1;
+}
+
+void arena_final(arena* t_arena)
+{
+	assert(t_arena);
+	
+	unsigned int i = 0;
+	for (; i < t_arena->chunks.element_count; ++i)
+	{
+		free(*((void**)vector_get_index(&t_arena->chunks, i)));
+	}
+	
+	vector_final(&t_arena->chunks);
+	t_arena->position = 0;
+	t_arena->end = 0;
+}
+
+int arena_merge(arena* t_arena, arena* t_other)
+{
+	assert(t_arena && t_other);
+	
+	/* the chunks change owner, the current chunk of t_arena stays current */
+	
+	if (!vector_push_many(&t_arena->chunks, t_other->chunks.buffer.data, t_other->chunks.element_count))
+	{
+		return 0;
+	}
+	
+	t_other->chunks.element_count = 0;
+	arena_final(t_other);
+	return 1;
+}
+
+void* arena_alloc(arena* t_arena, size_t t_size)
+{
+	assert(t_arena);
+	
+	t_size = (t_size + arena_alignment - 1) & ~(size_t)(arena_alignment - 1);
+	
+	if ((size_t)(t_arena->end - t_arena->position) >= t_size && t_arena->position)
+	{
+		void* output = t_arena->position;
+		t_arena->position += t_size;
+		return output;
+	}
+	
+	if (t_size > t_arena->chunk_size / 4)
+	{
+		/* large allocations get a chunk of their own so the current chunk keeps its space */
+		
+		void* output = malloc(t_size);
+		if (!output)
+		{
+			return 0;
+		}
+		if (!vector_push(&t_arena->chunks, &output))
+		{
+			free(output);
+			return 0;
+		}
+		return output;
+	}
+	
+	char* chunk = (char*)malloc(t_arena->chunk_size);
+	if (!chunk)
+	{
+		return 0;
+	}
+	if (!vector_push(&t_arena->chunks, &chunk))
+	{
+		free(chunk);
+		return 0;
+	}
+	
+	t_arena->position = chunk + t_size;
+	t_arena->end = chunk + t_arena->chunk_size;
+	if (t_arena->chunk_size < arena_max_chunk_size)
+	{
+		t_arena->chunk_size *= 2;
+	}
+	
+	return chunk;
+}
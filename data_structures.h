@@ -60,6 +60,9 @@ int vector_find(p_vector t_vector, void* t_ptr);
 /* pushes an entry into a vector */
 int vector_push(p_vector t_vector, const void* t_data);
 
+/* pushes t_count entries at once into a vector */
+int vector_push_many(p_vector t_vector, const void* t_data, unsigned int t_count);
+
 /* removes an entry at index from a vector */
 void vector_remove(p_vector t_vector, unsigned int t_index);
 
@@ -163,4 +166,27 @@ void* factory_alloc(p_factory t_factory);
 /* returns a factory element to the factories list of freed elements */
 int factory_free(p_factory t_factory, void* t_memptr);
 
+#define arena_alignment 16
+#define arena_max_chunk_size ((size_t)1 << 24)
+
+typedef struct
+{
+	vector chunks;
+	size_t chunk_size;
+	char* position;
+	char* end;
+} arena, *p_arena;
+
+/* initializes a memory arena which allocates in chunks starting at t_chunk_size bytes */
+int arena_init(arena* t_arena, size_t t_chunk_size);
+
+/* finalizes a memory arena, releasing every allocation made from it at once */
+void arena_final(arena* t_arena);
+
+/* moves every allocation of t_other into t_arena, leaving t_other finalized */
+int arena_merge(arena* t_arena, arena* t_other);
+
+/* allocates t_size bytes from the arena, aligned to arena_alignment, allocations are not freed individually */
+void* arena_alloc(p_arena t_arena, size_t t_size);
+
 #endif
\ No newline at end of file
@@ -1,9 +1,27 @@
 
+#if defined(__linux__) && !defined(_POSIX_C_SOURCE)
+
+#define _POSIX_C_SOURCE 200809L
+
+#endif
+
 #include "json_import.h"
+#include "json_powers.h"
+#include "thread.h"
 
 #include "assert.h"
+#include "float.h"
+#include "locale.h"
+#include "math.h"
 #include "stdio.h"
 
+#if defined(__linux__)
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#endif
+
 #ifndef JSON_DEBUG
 #define JSON_DEBUG 1
 #endif
@@ -24,6 +42,68 @@
 #define JSON_DEBUG_LOG_STRINGIFY 1
 #endif
 
+#ifndef JSON_SIMD
+#define JSON_SIMD 1
+#endif
+
+#ifndef JSON_ARENA_CHUNK_SIZE
+#define JSON_ARENA_CHUNK_SIZE 65536
+#endif
+
+#ifndef JSON_MAX_DEPTH
+#define JSON_MAX_DEPTH 1024
+#endif
+
+#ifndef JSON_READER_CHUNK_SIZE
+#define JSON_READER_CHUNK_SIZE 65536
+#endif
+
+#ifndef JSON_WRITER_BUFFER_SIZE
+#define JSON_WRITER_BUFFER_SIZE 65536
+#endif
+
+#ifndef JSON_PARALLEL_MIN_SIZE
+#define JSON_PARALLEL_MIN_SIZE ((size_t)1 << 22)
+#endif
+
+#ifndef JSON_PATH_NAME_SIZE
+#define JSON_PATH_NAME_SIZE 256
+#endif
+
+#ifndef JSON_LINES_MIN_PART_SIZE
+#define JSON_LINES_MIN_PART_SIZE ((size_t)1 << 20)
+#endif
+
+#ifndef JSON_LINES_MAX_PART_SIZE
+#define JSON_LINES_MAX_PART_SIZE ((size_t)1 << 28)
+#endif
+
+#ifndef JSON_OBJECT_INDEX_MIN
+#define JSON_OBJECT_INDEX_MIN 8
+#endif
+
+#if JSON_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+
+#define JSON_SIMD_SSE2 1
+#include <emmintrin.h>
+
+#if defined(_MSC_VER)
+
+#define JSON_SIMD_AVX2 1
+#define JSON_TARGET_AVX2
+#include <immintrin.h>
+#include <intrin.h>
+
+#elif defined(__GNUC__) || defined(__clang__)
+
+#define JSON_SIMD_AVX2 1
+#define JSON_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+
+#endif
+
+#endif
+
 #ifndef JSON_NOP
 #define JSON_NOP (void)printf
 #endif
@@ -69,865 +149,7697 @@
 
 const json_value json_undefined = {0};
 
+int json_mapping_read(json_mapping* t_mapping, const char* t_path)
+{
+	assert(t_mapping && t_path);
+	
+	FILE* file = fopen(t_path, "rb");
+	if (!file)
+	{
+		JSON_LOG("failed to open file");
+		return 0;
+	}
+	
+	long int file_length = -1;
+	if (!fseek(file, 0, SEEK_END))
+	{
+		file_length = ftell(file);
+	}
+	if (file_length < 0 || fseek(file, 0, SEEK_SET))
+	{
+		JSON_LOG("failed to find file length");
+		fclose(file);
+		return 0;
+	}
+	
+	char* data = (char*)malloc(file_length ? (size_t)file_length : 1);
+	if (!data || fread(data, 1, (size_t)file_length, file) != (size_t)file_length)
+	{
+		JSON_LOG("failed to read file");
+		free(data);
+		fclose(file);
+		return 0;
+	}
+	fclose(file);
+	
+	t_mapping->data = data;
+	t_mapping->size = (size_t)file_length;
+	t_mapping->is_mapped = 0;
+	t_mapping->is_allocated = 1;
+	
+	return 1;
+}
+
+int json_mapping_init(json_mapping* t_mapping, const char* t_path)
+{
+	assert(t_mapping && t_path);
+
+#if defined(_WIN32)
+	
+	HANDLE file = CreateFileA(t_path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		JSON_LOG("failed to open file");
+		return 0;
+	}
+	
+	LARGE_INTEGER file_length;
+	if (!GetFileSizeEx(file, &file_length) || file_length.QuadPart == 0)
+	{
+		CloseHandle(file);
+		return json_mapping_read(t_mapping, t_path);
+	}
+	
+	HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+	CloseHandle(file);
+	if (!mapping)
+	{
+		return json_mapping_read(t_mapping, t_path);
+	}
+	
+	void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data)
+	{
+		CloseHandle(mapping);
+		return json_mapping_read(t_mapping, t_path);
+	}
+	
+	t_mapping->data = (const char*)data;
+	t_mapping->size = (size_t)file_length.QuadPart;
+	t_mapping->is_mapped = 1;
+	t_mapping->is_allocated = 0;
+	t_mapping->mapping = mapping;
+	
+	return 1;
+
+#elif defined(__linux__)
+	
+	FILE* file = fopen(t_path, "rb");
+	if (!file)
+	{
+		JSON_LOG("failed to open file");
+		return 0;
+	}
+	
+	struct stat status;
+	if (fstat(fileno(file), &status) || !S_ISREG(status.st_mode) || status.st_size == 0)
+	{
+		fclose(file);
+		return json_mapping_read(t_mapping, t_path);
+	}
+	
+	void* data = mmap(0, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+	fclose(file);
+	if (data == MAP_FAILED)
+	{
+		return json_mapping_read(t_mapping, t_path);
+	}
+
+#if defined(POSIX_MADV_SEQUENTIAL)
+	posix_madvise(data, (size_t)status.st_size, POSIX_MADV_SEQUENTIAL);
+#endif
+	
+	t_mapping->data = (const char*)data;
+	t_mapping->size = (size_t)status.st_size;
+	t_mapping->is_mapped = 1;
+	t_mapping->is_allocated = 0;
+	
+	return 1;
+
+#else
+	
+	return json_mapping_read(t_mapping, t_path);
+
+#endif
+}
+
+void json_mapping_final(json_mapping* t_mapping)
+{
+	assert(t_mapping);
+	
+	if (t_mapping->is_mapped)
+	{
+
+#if defined(_WIN32)
+		
+		UnmapViewOfFile(t_mapping->data);
+		CloseHandle(t_mapping->mapping);
+
+#elif defined(__linux__)
+		
+		munmap((void*)t_mapping->data, t_mapping->size);
+
+#endif
+	
+	}
+	else if (t_mapping->is_allocated)
+	{
+		free((void*)t_mapping->data);
+	}
+	
+	t_mapping->data = 0;
+	t_mapping->size = 0;
+	t_mapping->is_mapped = 0;
+	t_mapping->is_allocated = 0;
+}
+
+typedef unsigned long long int json_mask;
+
+typedef struct
+{
+	json_mask quote;
+	json_mask backslash;
+	json_mask operators;
+	json_mask whitespace;
+} json_block_masks, *p_json_block_masks;
+
+typedef void (*json_classify_func)(const char* t_block, p_json_block_masks t_out_masks);
+
+#define json_character_quote 0x01
+#define json_character_backslash 0x02
+#define json_character_operator 0x04
+#define json_character_whitespace 0x08
+
+unsigned char json_character_classes[256];
+
+void json_character_classes_init(void)
+{
+	json_character_classes['"'] = json_character_quote;
+	json_character_classes['\\'] = json_character_backslash;
+	json_character_classes['{'] = json_character_operator;
+	json_character_classes['}'] = json_character_operator;
+	json_character_classes['['] = json_character_operator;
+	json_character_classes[']'] = json_character_operator;
+	json_character_classes[':'] = json_character_operator;
+	json_character_classes[','] = json_character_operator;
+	json_character_classes[' '] = json_character_whitespace;
+	json_character_classes['\t'] = json_character_whitespace;
+	json_character_classes['\n'] = json_character_whitespace;
+	json_character_classes['\r'] = json_character_whitespace;
+}
+
 int is_whitespace(char t_c)
 {
 	return t_c == ' ' || t_c == '\t' || t_c == '\n' || t_c == '\r';
 }
 
-int json_skip_whitespace(FILE* t_file)
+int is_digit(char t_c)
 {
-	assert(t_file);
+	return t_c >= '0' && t_c <= '9';
+}
+
+int is_scalar_terminator(char t_c)
+{
+	return is_whitespace(t_c) || t_c == ',' || t_c == ']' || t_c == '}' || t_c == ':';
+}
+
+unsigned int json_trailing_zeros(json_mask t_mask)
+{
+	assert(t_mask);
+
+#if defined(__GNUC__) || defined(__clang__)
 	
-	char c;
-	do
+	return (unsigned int)__builtin_ctzll(t_mask);
+
+#elif defined(_MSC_VER) && defined(_M_X64)
+	
+	unsigned long index;
+	_BitScanForward64(&index, t_mask);
+	return (unsigned int)index;
+
+#else
+	
+	unsigned int count = 0;
+	while (!(t_mask & 1))
 	{
-		if (!fread(&c, 1, 1, t_file))
-		{
-			JSON_LOG("failed to read whitespace");
-			return 0;
-		}
+		t_mask >>= 1;
+		++count;
+	}
+	return count;
+
+#endif
+}
+
+json_mask json_prefix_xor(json_mask t_mask)
+{
+	t_mask ^= t_mask << 1;
+	t_mask ^= t_mask << 2;
+	t_mask ^= t_mask << 4;
+	t_mask ^= t_mask << 8;
+	t_mask ^= t_mask << 16;
+	t_mask ^= t_mask << 32;
+	return t_mask;
+}
+
+void json_classify_scalar(const char* t_block, p_json_block_masks t_out_masks)
+{
+	assert(t_block && t_out_masks);
+	
+	json_mask quote = 0;
+	json_mask backslash = 0;
+	json_mask operators = 0;
+	json_mask whitespace = 0;
+	
+	unsigned int i = 0;
+	for (; i < 64; ++i)
+	{
+		unsigned char character_class = json_character_classes[(unsigned char)t_block[i]];
+		json_mask bit = (json_mask)1 << i;
+		
+		quote |= (character_class & json_character_quote) ? bit : 0;
+		backslash |= (character_class & json_character_backslash) ? bit : 0;
+		operators |= (character_class & json_character_operator) ? bit : 0;
+		whitespace |= (character_class & json_character_whitespace) ? bit : 0;
 	}
-	while (is_whitespace(c));
 	
-	return !fseek(t_file, -1, SEEK_CUR);
+	t_out_masks->quote = quote;
+	t_out_masks->backslash = backslash;
+	t_out_masks->operators = operators;
+	t_out_masks->whitespace = whitespace;
 }
 
-int json_read_string(FILE* t_file, buffer* t_out_string)
+#if JSON_SIMD_SSE2
+
+json_mask json_classify_sse2_mask(__m128i t_a, __m128i t_b, __m128i t_c, __m128i t_d)
 {
-	assert(t_file);
-	assert(t_out_string);
+	return (json_mask)(unsigned int)_mm_movemask_epi8(t_a)
+		| ((json_mask)(unsigned int)_mm_movemask_epi8(t_b) << 16)
+		| ((json_mask)(unsigned int)_mm_movemask_epi8(t_c) << 32)
+		| ((json_mask)(unsigned int)_mm_movemask_epi8(t_d) << 48);
+}
+
+void json_classify_sse2(const char* t_block, p_json_block_masks t_out_masks)
+{
+	assert(t_block && t_out_masks);
 	
-	JSON_LOG("begin read string");
+	__m128i quote[4];
+	__m128i backslash[4];
+	__m128i operators[4];
+	__m128i whitespace[4];
+	
+	unsigned int i = 0;
+	for (; i < 4; ++i)
+	{
+		__m128i characters = _mm_loadu_si128((const __m128i*)(t_block + (i * 16)));
+		
+		quote[i] = _mm_cmpeq_epi8(characters, _mm_set1_epi8('"'));
+		backslash[i] = _mm_cmpeq_epi8(characters, _mm_set1_epi8('\\'));
+		
+		operators[i] = _mm_or_si128(
+			_mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi8(characters, _mm_set1_epi8('{')), _mm_cmpeq_epi8(characters, _mm_set1_epi8('}'))),
+				_mm_or_si128(_mm_cmpeq_epi8(characters, _mm_set1_epi8('[')), _mm_cmpeq_epi8(characters, _mm_set1_epi8(']')))),
+			_mm_or_si128(_mm_cmpeq_epi8(characters, _mm_set1_epi8(':')), _mm_cmpeq_epi8(characters, _mm_set1_epi8(','))));
+		
+		whitespace[i] = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(characters, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(characters, _mm_set1_epi8('\t'))),
+			_mm_or_si128(_mm_cmpeq_epi8(characters, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(characters, _mm_set1_epi8('\r'))));
+	}
+	
+	t_out_masks->quote = json_classify_sse2_mask(quote[0], quote[1], quote[2], quote[3]);
+	t_out_masks->backslash = json_classify_sse2_mask(backslash[0], backslash[1], backslash[2], backslash[3]);
+	t_out_masks->operators = json_classify_sse2_mask(operators[0], operators[1], operators[2], operators[3]);
+	t_out_masks->whitespace = json_classify_sse2_mask(whitespace[0], whitespace[1], whitespace[2], whitespace[3]);
+}
+
+#endif
+
+#if JSON_SIMD_AVX2
+
+JSON_TARGET_AVX2 json_mask json_classify_avx2_mask(__m256i t_a, __m256i t_b)
+{
+	return (json_mask)(unsigned int)_mm256_movemask_epi8(t_a)
+		| ((json_mask)(unsigned int)_mm256_movemask_epi8(t_b) << 32);
+}
+
+JSON_TARGET_AVX2 void json_classify_avx2(const char* t_block, p_json_block_masks t_out_masks)
+{
+	assert(t_block && t_out_masks);
+	
+	__m256i quote[2];
+	__m256i backslash[2];
+	__m256i operators[2];
+	__m256i whitespace[2];
+	
+	unsigned int i = 0;
+	for (; i < 2; ++i)
+	{
+		__m256i characters = _mm256_loadu_si256((const __m256i*)(t_block + (i * 32)));
+		
+		quote[i] = _mm256_cmpeq_epi8(characters, _mm256_set1_epi8('"'));
+		backslash[i] = _mm256_cmpeq_epi8(characters, _mm256_set1_epi8('\\'));
+		
+		operators[i] = _mm256_or_si256(
+			_mm256_or_si256(
+				_mm256_or_si256(_mm256_cmpeq_epi8(characters, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(characters, _mm256_set1_epi8('}'))),
+				_mm256_or_si256(_mm256_cmpeq_epi8(characters, _mm256_set1_epi8('[')), _mm256_cmpeq_epi8(characters, _mm256_set1_epi8(']')))),
+			_mm256_or_si256(_mm256_cmpeq_epi8(characters, _mm256_set1_epi8(':')), _mm256_cmpeq_epi8(characters, _mm256_set1_epi8(','))));
+		
+		whitespace[i] = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpeq_epi8(characters, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(characters, _mm256_set1_epi8('\t'))),
+			_mm256_or_si256(_mm256_cmpeq_epi8(characters, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(characters, _mm256_set1_epi8('\r'))));
+	}
 	
-	char s[1024] = {0};
+	t_out_masks->quote = json_classify_avx2_mask(quote[0], quote[1]);
+	t_out_masks->backslash = json_classify_avx2_mask(backslash[0], backslash[1]);
+	t_out_masks->operators = json_classify_avx2_mask(operators[0], operators[1]);
+	t_out_masks->whitespace = json_classify_avx2_mask(whitespace[0], whitespace[1]);
+}
+
+int json_has_avx2(void)
+{
+
+#if defined(_MSC_VER)
 	
-	if (!fread(s, 1, 1, t_file) || s[0] != '"')
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+	{
+		return 0;
+	}
+	__cpuid(info, 1);
+	if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)) || (_xgetbv(0) & 0x06) != 0x06)
 	{
-		JSON_LOG("failed to read opening quote");
 		return 0;
 	}
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) ? 1 : 0;
+
+#else
+	
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? 1 : 0;
+
+#endif
+
+}
+
+#endif
+
+json_classify_func json_classify = 0;
+
+json_classify_func json_find_classify(void)
+{
+	if (json_classify)
+	{
+		return json_classify;
+	}
+	
+	json_character_classes_init();
+	
+	json_classify_func classify = json_classify_scalar;
+
+#if JSON_SIMD_SSE2
+	classify = json_classify_sse2;
+#endif
+
+#if JSON_SIMD_AVX2
+	if (json_has_avx2())
+	{
+		classify = json_classify_avx2;
+	}
+#endif
 	
-	s[0] = '\0';
-	char* c = s;
-	int is_expecting_escape_character = 0;
+	json_classify = classify;
+	return classify;
+}
+
+int json_scan(const char* t_data, size_t t_size, p_vector t_out_structurals)
+{
+	assert(t_data || !t_size);
+	assert(t_out_structurals);
+	
+	JSON_LOG("begin scan");
+	
+	if (t_size >= (size_t)0xffffffff)
+	{
+		JSON_LOG("document is too large to index");
+		return 0;
+	}
 	
-	if (!buffer_init(t_out_string, 0))
+	if (!vector_init(t_out_structurals, sizeof(unsigned int)) || !vector_resize(t_out_structurals, (unsigned int)(t_size / 4) + 64))
 	{
-		JSON_LOG("failed to initialize buffer");
+		JSON_LOG("failed to initialize structural index");
+		vector_final(t_out_structurals);
 		return 0;
 	}
 	
-	goto json_read_c;
+	json_classify_func classify = json_find_classify();
 	
-	while (is_expecting_escape_character || *c != '"')
+	json_mask is_previous_escaped = 0;
+	json_mask is_previous_in_string = 0;
+	json_mask is_previous_scalar = 0;
+	
+	size_t offset = 0;
+	for (; offset < t_size; offset += 64)
 	{
-		if (*c == '\\')
+		const char* block = t_data + offset;
+		char padded_block[64];
+		
+		if (t_size - offset < 64)
 		{
-			is_expecting_escape_character = 1;
-			goto json_read_c;
+			memset(padded_block, ' ', sizeof(padded_block));
+			memcpy(padded_block, block, t_size - offset);
+			block = padded_block;
 		}
-		if (is_expecting_escape_character)
+		
+		json_block_masks masks;
+		classify(block, &masks);
+		
+		/* a backslash escapes the next character unless it is itself escaped, backslashes are rare so walk them */
+		
+		json_mask escaped = is_previous_escaped;
+		json_mask backslash = masks.backslash & ~is_previous_escaped;
+		is_previous_escaped = 0;
+		while (backslash)
 		{
-			is_expecting_escape_character = 0;
-			
-			if (*c == 'b')
-			{
-				*c = '\b';
-			}
-			else if (*c == 'f')
+			unsigned int i = json_trailing_zeros(backslash);
+			backslash &= backslash - 1;
+			if (escaped & ((json_mask)1 << i))
 			{
-				*c = '\f';
+				continue;
 			}
-			else if (*c == 'n')
+			if (i == 63)
 			{
-				*c = '\n';
+				is_previous_escaped = 1;
 			}
-			else if (*c == 't')
+			else
 			{
-				*c = '\t';
+				escaped |= (json_mask)1 << (i + 1);
+				backslash &= ~((json_mask)1 << (i + 1));
 			}
 		}
 		
-		++c;
-		if (c == s + sizeof(s))
+		json_mask quote = masks.quote & ~escaped;
+		json_mask in_string = json_prefix_xor(quote) ^ is_previous_in_string;
+		is_previous_in_string = (in_string >> 63) ? ~(json_mask)0 : 0;
+		
+		json_mask scalar = ~(masks.operators | masks.whitespace | quote);
+		json_mask scalar_start = scalar & ~((scalar << 1) | is_previous_scalar);
+		is_previous_scalar = scalar >> 63;
+		
+		json_mask structurals = ((masks.operators | scalar_start) & ~in_string) | quote;
+		if (t_size - offset < 64)
 		{
-			if (!buffer_append(t_out_string, s, 1024))
-			{
-				JSON_LOG("failed to append large string");
-				buffer_final(t_out_string);
-				return 0;
-			}
-			memset(s, 0, 1024);
-			c = s;
+			structurals &= ((json_mask)1 << (t_size - offset)) - 1;
 		}
 		
-json_read_c:
-		if (!fread(c, 1, 1, t_file))
+		unsigned int count = t_out_structurals->element_count;
+		if (vector_find_capacity(t_out_structurals) < count + 64 && !vector_resize(t_out_structurals, (count + 64) * 2))
 		{
-			JSON_LOG("failed to read string character");
-			buffer_final(t_out_string);
+			JSON_LOG("failed to grow structural index");
+			vector_final(t_out_structurals);
 			return 0;
 		}
+		
+		unsigned int* output = (unsigned int*)t_out_structurals->buffer.data + count;
+		while (structurals)
+		{
+			*output++ = (unsigned int)offset + json_trailing_zeros(structurals);
+			structurals &= structurals - 1;
+		}
+		t_out_structurals->element_count = (unsigned int)(output - (unsigned int*)t_out_structurals->buffer.data);
 	}
-	*c = '\0';
 	
-	if (!buffer_append(t_out_string, s, (c - s) + 1))
+	if (is_previous_in_string)
 	{
-		JSON_LOG("failed to append string");
-		buffer_final(t_out_string);
+		JSON_LOG("unterminated string");
+		vector_final(t_out_structurals);
 		return 0;
 	}
 	
-	JSON_LOG("succeed read string");
+	JSON_LOG("succeed scan");
 	
 	return 1;
 }
 
-int json_read_value(FILE* t_file, json_file * t_json, json_value* t_out_value)
+typedef struct
 {
-	assert(t_file);
-	
+	const char* data;
+	const char* end;
+	const unsigned int* structural;
+	const unsigned int* structural_end;
+	const unsigned int* prebuilt;
+	const unsigned int* prebuilt_end;
+	json_value prebuilt_value;
+	vector values;
+	vector frames;
+	unsigned int max_depth;
+	int exact_integers;
+	int validate_utf8;
+} json_cursor, *p_json_cursor;
+
+/* an object's properties gather on the value stack two slots apiece until it closes */
+#define json_property_slots (sizeof(json_property) / sizeof(json_value))
+
+/* fails to compile where a property is not a whole number of value slots, which would truncate properties pushed to the stack */
+typedef char json_property_slots_check[sizeof(json_property) % sizeof(json_value) == 0 ? 1 : -1];
+
+typedef struct
+{
+	json_value value;
+	const char* key;
+	unsigned int key_length;
+	unsigned int hash;
+	unsigned int first_value;
+	unsigned int span;
+} json_frame, *p_json_frame;
+
+const char* json_peek(p_json_cursor t_cursor)
+{
+	assert(t_cursor);
+	
+	return t_cursor->structural != t_cursor->structural_end ? t_cursor->data + *t_cursor->structural : 0;
+}
+
+const char* json_next(p_json_cursor t_cursor)
+{
+	assert(t_cursor);
+	
+	return t_cursor->structural != t_cursor->structural_end ? t_cursor->data + *t_cursor->structural++ : 0;
+}
+
+const char* json_skip_digits(const char* t_c, const char* t_end)
+{
+	while (t_c != t_end && is_digit(*t_c))
+	{
+		++t_c;
+	}
+	return t_c;
+}
+
+int json_read_literal(p_json_cursor t_cursor, const char* t_c, const char* t_literal)
+{
+	assert(t_cursor && t_c && t_literal);
+	
+	size_t length = strlen(t_literal);
+	if ((size_t)(t_cursor->end - t_c) < length || memcmp(t_c, t_literal, length))
+	{
+		return 0;
+	}
+	
+	return t_c + length == t_cursor->end || is_scalar_terminator(t_c[length]);
+}
+
+const char json_unescape_characters[256] = { ['"'] = '"', ['\\'] = '\\', ['/'] = '/', ['b'] = '\b', ['f'] = '\f', ['n'] = '\n', ['r'] = '\r', ['t'] = '\t' };
+
+unsigned int json_read_hex(const char* t_c)
+{
+	/* reads four hex digits, any other character gives a value past the basic plane */
+	
+	unsigned int code = 0;
+	unsigned int i = 0;
+	
+	for (; i < 4; ++i)
+	{
+		char c = t_c[i];
+		char lower = (char)(c | 0x20);
+		unsigned int digit = is_digit(c) ? (unsigned int)(c - '0') : lower >= 'a' && lower <= 'f' ? (unsigned int)(lower - 'a' + 10) : 0x10000;
+		code = (code << 4) | digit;
+	}
+	return code;
+}
+
+unsigned int json_decode_escape(const char** t_c, const char* t_end, char* t_out)
+{
+	/* decodes the escape following a backslash to utf-8 and moves past it, returns the bytes written or 0 when it is not valid */
+	
+	const char* c = *t_c;
+	
+	if (c == t_end)
+	{
+		return 0;
+	}
+	if (*c != 'u')
+	{
+		*t_out = json_unescape_characters[(unsigned char)*c];
+		*t_c = c + 1;
+		return *t_out ? 1 : 0;
+	}
+	if (t_end - c < 5)
+	{
+		return 0;
+	}
+	
+	unsigned int code = json_read_hex(c + 1);
+	c += 5;
+	
+	if (code >= 0xd800 && code < 0xdc00)
+	{
+		/* a high surrogate pairs with the escaped low surrogate after it */
+		
+		unsigned int low = t_end - c >= 6 && c[0] == '\\' && c[1] == 'u' ? json_read_hex(c + 2) : 0;
+		if (low < 0xdc00 || low >= 0xe000)
+		{
+			return 0;
+		}
+		code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+		c += 6;
+	}
+	else if (code > 0xffff || (code >= 0xdc00 && code < 0xe000))
+	{
+		return 0;
+	}
+	*t_c = c;
+	
+	if (code < 0x80)
+	{
+		t_out[0] = (char)code;
+		return 1;
+	}
+	if (code < 0x800)
+	{
+		t_out[0] = (char)(0xc0 | (code >> 6));
+		t_out[1] = (char)(0x80 | (code & 0x3f));
+		return 2;
+	}
+	if (code < 0x10000)
+	{
+		t_out[0] = (char)(0xe0 | (code >> 12));
+		t_out[1] = (char)(0x80 | ((code >> 6) & 0x3f));
+		t_out[2] = (char)(0x80 | (code & 0x3f));
+		return 3;
+	}
+	t_out[0] = (char)(0xf0 | (code >> 18));
+	t_out[1] = (char)(0x80 | ((code >> 12) & 0x3f));
+	t_out[2] = (char)(0x80 | ((code >> 6) & 0x3f));
+	t_out[3] = (char)(0x80 | (code & 0x3f));
+	return 4;
+}
+
+char* json_decode_string(const char* t_input, const char* t_end, const char* t_escape, char* t_output)
+{
+	/* copies the runs between escapes whole and decodes each escape, returns the end of the output or 0 on a bad escape, the output may be the input since it never grows */
+	
+	while (t_escape)
+	{
+		memmove(t_output, t_input, (size_t)(t_escape - t_input));
+		t_output += t_escape - t_input;
+		t_input = t_escape + 1;
+		
+		unsigned int length = json_decode_escape(&t_input, t_end, t_output);
+		if (!length)
+		{
+			JSON_LOG("escape is not valid");
+			return 0;
+		}
+		t_output += length;
+		
+		t_escape = (const char*)memchr(t_input, '\\', (size_t)(t_end - t_input));
+	}
+	memmove(t_output, t_input, (size_t)(t_end - t_input));
+	return t_output + (t_end - t_input);
+}
+
+int json_validate_utf8(const char* t_c, const char* t_end)
+{
+	/* checks for well formed utf-8, rejecting overlong forms, surrogates and code points past 0x10ffff */
+	
+	const unsigned char* c = (const unsigned char*)t_c;
+	const unsigned char* end = (const unsigned char*)t_end;
+	
+	while (c != end)
+	{
+#if JSON_SIMD_SSE2
+		
+		/* blocks of ascii are passed over sixteen at a time */
+		
+		if (end - c >= 16 && !_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)c)))
+		{
+			c += 16;
+			continue;
+		}
+
+#endif
+		if (*c < 0x80)
+		{
+			++c;
+			continue;
+		}
+		if (*c < 0xc2 || *c > 0xf4)
+		{
+			return 0;
+		}
+		
+		unsigned int length = *c >= 0xf0 ? 4 : *c >= 0xe0 ? 3 : 2;
+		unsigned char low = *c == 0xe0 ? 0xa0 : *c == 0xf0 ? 0x90 : 0x80;
+		unsigned char high = *c == 0xed ? 0x9f : *c == 0xf4 ? 0x8f : 0xbf;
+		
+		if ((size_t)(end - c) < length || c[1] < low || c[1] > high)
+		{
+			return 0;
+		}
+		
+		unsigned int i = 2;
+		for (; i < length; ++i)
+		{
+			if ((c[i] & 0xc0) != 0x80)
+			{
+				return 0;
+			}
+		}
+		c += length;
+	}
+	return 1;
+}
+
+int json_read_string(p_json_cursor t_cursor, p_arena t_arena, json_string* t_out_string)
+{
+	assert(t_cursor);
+	assert(t_arena);
+	assert(t_out_string);
+	
+	JSON_LOG("begin read string");
+	
+	const char* start = json_next(t_cursor);
+	const char* end = json_next(t_cursor);
+	
+	if (!start || *start != '"' || !end || *end != '"')
+	{
+		JSON_LOG("failed to read quotes");
+		return 0;
+	}
+	++start;
+	
+	if (t_cursor->validate_utf8 && !json_validate_utf8(start, end))
+	{
+		JSON_LOG("string is not valid utf-8");
+		return 0;
+	}
+	
+	const char* escape = (const char*)memchr(start, '\\', (size_t)(end - start));
+	
+	if (!escape)
+	{
+		/* nothing to decode, so refer to the text */
+		
+		t_out_string->data = (void*)start;
+		t_out_string->size = (size_t)(end - start);
+		
+		JSON_LOG("succeed read string view");
+		
+		return 1;
+	}
+	
+	char* decoded = (char*)arena_alloc(t_arena, (size_t)(end - start) + 1);
+	
+	if (!decoded)
+	{
+		JSON_LOG("failed to allocate decoded string");
+		return 0;
+	}
+	
+	char* output = json_decode_string(start, end, escape, decoded);
+	
+	if (!output)
+	{
+		return 0;
+	}
+	*output = '\0';
+	
+	t_out_string->data = decoded;
+	t_out_string->size = (size_t)(output - decoded);
+	
+	JSON_LOG("succeed read string");
+	
+	return 1;
+}
+
+unsigned long long int json_multiply_128(unsigned long long int t_a, unsigned long long int t_b, unsigned long long int* t_out_high)
+{
+#if defined(__SIZEOF_INT128__)
+	
+	unsigned __int128 product = (unsigned __int128)t_a * t_b;
+	*t_out_high = (unsigned long long int)(product >> 64);
+	return (unsigned long long int)product;
+
+#elif defined(_MSC_VER) && defined(_M_X64)
+	
+	return _umul128(t_a, t_b, t_out_high);
+
+#else
+	
+	unsigned long long int a_low = t_a & 0xffffffff, a_high = t_a >> 32;
+	unsigned long long int b_low = t_b & 0xffffffff, b_high = t_b >> 32;
+	unsigned long long int low = a_low * b_low;
+	unsigned long long int middle_a = a_high * b_low + (low >> 32);
+	unsigned long long int middle_b = a_low * b_high + (middle_a & 0xffffffff);
+	*t_out_high = a_high * b_high + (middle_a >> 32) + (middle_b >> 32);
+	return (middle_b << 32) | (low & 0xffffffff);
+
+#endif
+}
+
+unsigned int json_leading_zeros(unsigned long long int t_value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	
+	return (unsigned int)__builtin_clzll(t_value);
+
+#else
+	
+	unsigned int count = 0;
+	while (!(t_value & 0x8000000000000000ULL))
+	{
+		t_value <<= 1;
+		++count;
+	}
+	return count;
+
+#endif
+}
+
+int json_eisel_lemire(unsigned long long int t_mantissa, int t_exponent, int t_is_negative, double* t_out_number)
+{
+	/* finds the double nearest t_mantissa * 10^t_exponent from a 128 bit approximation of the power of five, giving up when that approximation is too close to call */
+	
+	unsigned long long int bits;
+	
+	if (!t_mantissa || t_exponent < json_powers_min)
+	{
+		bits = 0;
+	}
+	else if (t_exponent > json_powers_max)
+	{
+		bits = (unsigned long long int)0x7ff << 52;
+	}
+	else
+	{
+		unsigned int zeros = json_leading_zeros(t_mantissa);
+		t_mantissa <<= zeros;
+		
+		const unsigned long long int* power = &json_powers_of_five[2 * (t_exponent - json_powers_min)];
+		unsigned long long int high;
+		unsigned long long int low = json_multiply_128(t_mantissa, power[0], &high);
+		
+		if ((high & 0x1ff) == 0x1ff)
+		{
+			unsigned long long int second_high;
+			json_multiply_128(t_mantissa, power[1], &second_high);
+			low += second_high;
+			high += second_high > low;
+		}
+		if (low == 0xffffffffffffffffULL && (t_exponent < -27 || t_exponent > 55))
+		{
+			return 0;
+		}
+		
+		unsigned int upper_bit = (unsigned int)(high >> 63);
+		unsigned long long int mantissa = high >> (upper_bit + 9);
+		int power2 = (int)((((152170 + 65536) * t_exponent) >> 16) + 63) + (int)upper_bit - (int)zeros + 1023;
+		
+		if (power2 <= 0)
+		{
+			/* subnormal */
+			
+			if (-power2 + 1 >= 64)
+			{
+				mantissa = 0;
+				power2 = 0;
+			}
+			else
+			{
+				mantissa >>= -power2 + 1;
+				mantissa += mantissa & 1;
+				mantissa >>= 1;
+				power2 = mantissa < ((unsigned long long int)1 << 52) ? 0 : 1;
+			}
+		}
+		else
+		{
+			/* halfway cases round to even */
+			
+			if (low <= 1 && t_exponent >= -4 && t_exponent <= 23 && (mantissa & 3) == 1 && (mantissa << (upper_bit + 9)) == high)
+			{
+				mantissa &= ~(unsigned long long int)1;
+			}
+			mantissa += mantissa & 1;
+			mantissa >>= 1;
+			if (mantissa >= ((unsigned long long int)2 << 52))
+			{
+				mantissa = (unsigned long long int)1 << 52;
+				++power2;
+			}
+			mantissa &= ~((unsigned long long int)1 << 52);
+			if (power2 >= 0x7ff)
+			{
+				power2 = 0x7ff;
+				mantissa = 0;
+			}
+		}
+		bits = mantissa | ((unsigned long long int)power2 << 52);
+	}
+	
+	bits |= (unsigned long long int)(t_is_negative ? 1 : 0) << 63;
+	memcpy(t_out_number, &bits, sizeof(bits));
+	return 1;
+}
+
+double json_strtod(const char* t_start, size_t t_length)
+{
+	/* strtod reads the decimal point of the current locale, so swap it in for the json one */
+	
+	char s[64];
+	char* number = t_length < sizeof(s) ? s : (char*)malloc(t_length + 1);
+	if (!number)
+	{
+		JSON_LOG("failed to allocate long number");
+		return 0.0;
+	}
+	memcpy(number, t_start, t_length);
+	number[t_length] = '\0';
+	
+	char point = *localeconv()->decimal_point;
+	if (point != '.')
+	{
+		char* dot = (char*)memchr(number, '.', t_length);
+		if (dot)
+		{
+			*dot = point;
+		}
+	}
+	
+	double result = strtod(number, 0);
+	
+	if (number != s)
+	{
+		free(number);
+	}
+	
+	return result;
+}
+
+const double json_exact_powers_of_ten[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+const char* json_parse_number(const char* t_start, const char* t_end, int t_exact_integers, json_value* t_out_value)
+{
+	assert(t_start && t_end && t_out_value);
+	
+	/* digits accumulate straight from the text, at most 19 of them fit the mantissa */
+	
+	const char* c = t_start;
+	int is_negative = c != t_end && *c == '-';
+	c += is_negative;
+	
+	unsigned long long int mantissa = 0;
+	unsigned int digit_count = 0;
+	int exponent = 0;
+	
+	const char* digits = c;
+	for (; c != t_end && is_digit(*c); ++c)
+	{
+		mantissa = mantissa * 10 + (unsigned long long int)(*c - '0');
+		digit_count += digit_count || mantissa;
+	}
+	if (c == digits)
+	{
+		JSON_LOG("failed to read integer digits");
+		return 0;
+	}
+	if (*digits == '0' && c - digits > 1)
+	{
+		JSON_LOG("integer part has a leading zero");
+		return 0;
+	}
+	
+	int is_integer = 1;
+	if (c != t_end && *c == '.')
+	{
+		is_integer = 0;
+		digits = ++c;
+		for (; c != t_end && is_digit(*c); ++c)
+		{
+			mantissa = mantissa * 10 + (unsigned long long int)(*c - '0');
+			digit_count += digit_count || mantissa;
+		}
+		if (c == digits)
+		{
+			JSON_LOG("failed to read decimal digits");
+			return 0;
+		}
+		exponent = -(int)(c - digits);
+	}
+	if (c != t_end && (*c == 'e' || *c == 'E'))
+	{
+		is_integer = 0;
+		++c;
+		int is_exponent_negative = c != t_end && *c == '-';
+		if (c != t_end && (*c == '-' || *c == '+'))
+		{
+			++c;
+		}
+		int explicit_exponent = 0;
+		digits = c;
+		for (; c != t_end && is_digit(*c); ++c)
+		{
+			explicit_exponent = explicit_exponent < 100000 ? explicit_exponent * 10 + (*c - '0') : explicit_exponent;
+		}
+		if (c == digits)
+		{
+			JSON_LOG("failed to read exponent digits");
+			return 0;
+		}
+		exponent += is_exponent_negative ? -explicit_exponent : explicit_exponent;
+	}
+	
+	if (digit_count > 19)
+	{
+		/* the mantissa overflowed, which needs the slow path to round correctly */
+		
+		t_out_value->type = json_data_type_number;
+		t_out_value->value.number = json_strtod(t_start, (size_t)(c - t_start));
+		return c;
+	}
+	
+	if (is_integer && t_exact_integers && mantissa > ((unsigned long long int)1 << 53) && mantissa <= (unsigned long long int)0x7fffffffffffffff + is_negative)
+	{
+		t_out_value->type = json_data_type_integer;
+		t_out_value->value.integer = is_negative ? (json_integer)(0 - mantissa) : (json_integer)mantissa;
+		return c;
+	}
+	
+	t_out_value->type = json_data_type_number;
+
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+	
+	if (mantissa <= ((unsigned long long int)1 << 53) && exponent >= -22 && exponent <= 22)
+	{
+		/* both the mantissa and the power of ten are exact doubles, so one rounding gives the right answer */
+		
+		double number = (double)mantissa;
+		number = exponent < 0 ? number / json_exact_powers_of_ten[-exponent] : number * json_exact_powers_of_ten[exponent];
+		t_out_value->value.number = is_negative ? -number : number;
+		return c;
+	}
+
+#endif
+	
+	if (!json_eisel_lemire(mantissa, exponent, is_negative, &t_out_value->value.number))
+	{
+		t_out_value->value.number = json_strtod(t_start, (size_t)(c - t_start));
+	}
+	return c;
+}
+
+int json_read_number(p_json_cursor t_cursor, const char* t_start, json_value* t_out_value)
+{
+	assert(t_cursor && t_start && t_out_value);
+	
+	const char* c = json_parse_number(t_start, t_cursor->end, t_cursor->exact_integers, t_out_value);
+	if (!c)
+	{
+		return 0;
+	}
+	if (c != t_cursor->end && !is_scalar_terminator(*c))
+	{
+		JSON_LOG("unexpected character after number");
+		return 0;
+	}
+	
+	return 1;
+}
+
+int json_read_scalar(p_json_cursor t_cursor, json_file* t_json, const char* t_start, json_value* t_out_value)
+{
+	assert(t_cursor && t_json && t_start && t_out_value);
+	
+	switch (*t_start)
+	{
+	case '"':
+	{
+		/* string */
+		
+		JSON_LOG("value is string");
+		
+		json_string* string = (json_string*)arena_alloc(&t_json->arena, sizeof(json_string));
+		
+		if (!string || !json_read_string(t_cursor, &t_json->arena, string))
+		{
+			JSON_LOG("failed to read string");
+			return 0;
+		}
+		
+		t_out_value->type = json_data_type_string;
+		t_out_value->value.blob = (p_json_blob)string;
+		return 1;
+	}
+	case '-':
+	case '0':
+	case '1':
+	case '2':
+	case '3':
+	case '4':
+	case '5':
+	case '6':
+	case '7':
+	case '8':
+	case '9':
+	{
+		/* number */
+		
+		JSON_LOG("value is number");
+		
+		json_next(t_cursor);
+		return json_read_number(t_cursor, t_start, t_out_value);
+	}
+	case 't':
+	case 'f':
+	{
+		/* boolean */
+		
+		JSON_LOG("value is boolean");
+		
+		json_next(t_cursor);
+		if (json_read_literal(t_cursor, t_start, "true"))
+		{
+			t_out_value->type = json_data_type_boolean;
+			t_out_value->value.boolean = 1;
+			return 1;
+		}
+		if (json_read_literal(t_cursor, t_start, "false"))
+		{
+			t_out_value->type = json_data_type_boolean;
+			t_out_value->value.boolean = 0;
+			return 1;
+		}
+		
+		JSON_LOG("unknown result, expected true or false");
+		return 0;
+	}
+	case 'n':
+	{
+		/* null */
+		
+		JSON_LOG("value is null");
+		
+		json_next(t_cursor);
+		if (!json_read_literal(t_cursor, t_start, "null"))
+		{
+			JSON_LOG("unknown result, expected null");
+			return 0;
+		}
+		t_out_value->type = json_data_type_null;
+		t_out_value->value.null = 0;
+		return 1;
+	}
+	default:
+	{
+		/* unknown */
+		
+		JSON_LOG("value is unexpected, fail out");
+		return 0;
+	}
+	}
+}
+
+int json_alloc_container(json_file* t_json, char t_c, json_value* t_out_value)
+{
+	assert(t_json && t_out_value);
+	
+	if (t_c == '{')
+	{
+		/* object */
+		
+		JSON_LOG("value is object");
+		
+		json_object* object = (json_object*)arena_alloc(&t_json->arena, sizeof(json_object));
+		
+		if (!object)
+		{
+			JSON_LOG("failed to allocate object");
+			return 0;
+		}
+		
+		object->properties.buffer.data = 0;
+		object->properties.buffer.size = 0;
+		object->properties.element_size = sizeof(json_property);
+		object->properties.element_count = 0;
+		object->index = 0;
+		object->index_capacity = 0;
+		t_out_value->type = json_data_type_object;
+		t_out_value->value.blob = (p_json_blob)object;
+		return 1;
+	}
+	
+	/* array */
+	
+	JSON_LOG("value is array");
+	
+	json_array* array = (json_array*)arena_alloc(&t_json->arena, sizeof(json_array));
+	
+	if (!array)
+	{
+		JSON_LOG("failed to allocate array");
+		return 0;
+	}
+	
+	array->buffer.data = 0;
+	array->buffer.size = 0;
+	array->element_size = sizeof(json_value);
+	array->element_count = 0;
+	t_out_value->type = json_data_type_array;
+	t_out_value->value.blob = (p_json_blob)array;
+	return 1;
+}
+
+int json_property_is(const json_property* t_property, const char* t_key, const char* t_interned, unsigned int t_length, unsigned int t_hash)
+{
+	/* interned names match by pointer without comparing characters, t_interned is only compared and never read so it may outlive its file */
+	
+	return t_property->hash == t_hash && t_property->key_length == t_length && (t_property->key == t_key || (t_interned && t_property->key == t_interned) || !t_length || !memcmp(t_property->key, t_key, t_length));
+}
+
+json_property* json_object_lookup(const json_object* t_object, const char* t_key, const char* t_interned, unsigned int t_length, unsigned int t_hash)
+{
+	json_property* properties = (json_property*)t_object->properties.buffer.data;
+	
+	if (!t_object->index)
+	{
+		/* small objects are scanned, comparing hashes before names */
+		
+		json_property* property = properties;
+		json_property* end = properties + t_object->properties.element_count;
+		for (; property != end; ++property)
+		{
+			if (json_property_is(property, t_key, t_interned, t_length, t_hash))
+			{
+				return property;
+			}
+		}
+		return 0;
+	}
+	
+	unsigned int mask = t_object->index_capacity - 1;
+	unsigned int slot = t_hash & mask;
+	for (; t_object->index[slot]; slot = (slot + 1) & mask)
+	{
+		json_property* property = properties + t_object->index[slot] - 1;
+		if (json_property_is(property, t_key, t_interned, t_length, t_hash))
+		{
+			return property;
+		}
+	}
+	return 0;
+}
+
+int json_object_index(p_arena t_arena, json_object* t_object, unsigned int t_capacity)
+{
+	/* slots hold a property's position plus one so zero is empty, the index is kept at most half full and is rebuilt rather than resized */
+	
+	unsigned int* index = t_capacity <= t_object->index_capacity ? t_object->index : (unsigned int*)arena_alloc(t_arena, t_capacity * sizeof(unsigned int));
+	
+	if (!index)
+	{
+		JSON_LOG("failed to allocate object index");
+		return 0;
+	}
+	
+	t_capacity = t_capacity > t_object->index_capacity ? t_capacity : t_object->index_capacity;
+	memset(index, 0, t_capacity * sizeof(unsigned int));
+	
+	const json_property* properties = (const json_property*)t_object->properties.buffer.data;
+	unsigned int mask = t_capacity - 1;
+	unsigned int i = 0;
+	for (; i < t_object->properties.element_count; ++i)
+	{
+		unsigned int slot = properties[i].hash & mask;
+		for (; index[slot]; slot = (slot + 1) & mask)
+		{
+			if (json_property_is(properties + index[slot] - 1, properties[i].key, 0, properties[i].key_length, properties[i].hash))
+			{
+				JSON_LOG("duplicate property");
+				return 0;
+			}
+		}
+		index[slot] = i + 1;
+	}
+	
+	t_object->index = index;
+	t_object->index_capacity = t_capacity;
+	return 1;
+}
+
+unsigned int json_object_index_capacity(unsigned int t_count)
+{
+	unsigned int capacity = 16;
+	while (capacity < t_count * 2)
+	{
+		capacity <<= 1;
+	}
+	return capacity;
+}
+
+int json_close_object(json_file* t_json, json_object* t_object)
+{
+	/* objects are indexed once they are whole, which finds duplicate names, small ones are only checked for them */
+	
+	unsigned int count = t_object->properties.element_count;
+	
+	if (count >= JSON_OBJECT_INDEX_MIN)
+	{
+		return json_object_index(&t_json->arena, t_object, json_object_index_capacity(count));
+	}
+	
+	const json_property* properties = (const json_property*)t_object->properties.buffer.data;
+	unsigned int i = 1;
+	for (; i < count; ++i)
+	{
+		unsigned int j = 0;
+		for (; j < i; ++j)
+		{
+			if (json_property_is(properties + j, properties[i].key, 0, properties[i].key_length, properties[i].hash))
+			{
+				JSON_LOG("duplicate property");
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+int json_close_frame(p_vector t_values, json_file* t_json, p_json_frame t_frame)
+{
+	assert(t_values && t_json && t_frame);
+	
+	if (t_frame->value.type == json_data_type_object)
+	{
+		/* properties are copied to the arena like an array's entries */
+		
+		json_object* object = &t_frame->value.value.blob->object;
+		unsigned int count = (t_values->element_count - t_frame->first_value) / json_property_slots;
+		size_t size = count * sizeof(json_property);
+		
+		if (count)
+		{
+			object->properties.buffer.data = arena_alloc(&t_json->arena, size);
+			if (!object->properties.buffer.data)
+			{
+				JSON_LOG("failed to allocate object properties");
+				return 0;
+			}
+			memcpy(object->properties.buffer.data, vector_get_index(t_values, t_frame->first_value), size);
+		}
+		object->properties.buffer.size = size;
+		object->properties.element_count = count;
+		t_values->element_count = t_frame->first_value;
+		
+		return json_close_object(t_json, object);
+	}
+	
+	if (t_frame->value.type != json_data_type_array)
+	{
+		return 1;
+	}
+	
+	/* entries gather on the value stack and are copied to the arena once their count is known */
+	
+	json_array* array = &t_frame->value.value.blob->array;
+	unsigned int count = t_values->element_count - t_frame->first_value;
+	size_t size = count * sizeof(json_value);
+	
+	if (count)
+	{
+		array->buffer.data = arena_alloc(&t_json->arena, size);
+		if (!array->buffer.data)
+		{
+			JSON_LOG("failed to allocate array entries");
+			return 0;
+		}
+		memcpy(array->buffer.data, vector_get_index(t_values, t_frame->first_value), size);
+	}
+	array->buffer.size = size;
+	array->element_count = count;
+	t_values->element_count = t_frame->first_value;
+	
+	return 1;
+}
+
+unsigned int json_key_hash(const char* t_key, size_t t_length)
+{
+	unsigned int hash = 2166136261u;
+	const char* end = t_key + t_length;
+	
+	for (; t_key != end; ++t_key)
+	{
+		hash = (hash ^ (unsigned char)*t_key) * 16777619u;
+	}
+	return hash;
+}
+
+int json_key_table_init(p_json_key_table t_table)
+{
+	t_table->capacity = 64;
+	t_table->count = 0;
+	t_table->slots = (json_key*)calloc(t_table->capacity, sizeof(json_key));
+	
+	return t_table->slots != 0;
+}
+
+void json_key_table_final(p_json_key_table t_table)
+{
+	free(t_table->slots);
+	t_table->slots = 0;
+	t_table->capacity = 0;
+	t_table->count = 0;
+}
+
+const char* json_key_table_find(const json_key_table* t_table, const char* t_key, size_t t_length, unsigned int t_hash)
+{
+	unsigned int mask = t_table->capacity - 1;
+	unsigned int i = t_hash & mask;
+	
+	for (; t_table->slots[i].key; i = (i + 1) & mask)
+	{
+		const json_key* slot = t_table->slots + i;
+		if (slot->hash == t_hash && slot->key_length == t_length && !memcmp(slot->key, t_key, t_length))
+		{
+			return slot->key;
+		}
+	}
+	return 0;
+}
+
+int json_key_table_insert(p_json_key_table t_table, const char* t_key, size_t t_length, unsigned int t_hash)
+{
+	/* kept at most half full so probes stay short */
+	
+	if ((t_table->count + 1) * 2 > t_table->capacity)
+	{
+		unsigned int capacity = t_table->capacity * 2;
+		json_key* slots = (json_key*)calloc(capacity, sizeof(json_key));
+		if (!slots)
+		{
+			JSON_LOG("failed to grow key table");
+			return 0;
+		}
+		
+		unsigned int i = 0;
+		for (; i < t_table->capacity; ++i)
+		{
+			if (t_table->slots[i].key)
+			{
+				unsigned int j = t_table->slots[i].hash & (capacity - 1);
+				while (slots[j].key)
+				{
+					j = (j + 1) & (capacity - 1);
+				}
+				slots[j] = t_table->slots[i];
+			}
+		}
+		free(t_table->slots);
+		t_table->slots = slots;
+		t_table->capacity = capacity;
+	}
+	
+	unsigned int mask = t_table->capacity - 1;
+	unsigned int i = t_hash & mask;
+	while (t_table->slots[i].key)
+	{
+		i = (i + 1) & mask;
+	}
+	t_table->slots[i].key = t_key;
+	t_table->slots[i].key_length = t_length;
+	t_table->slots[i].hash = t_hash;
+	++t_table->count;
+	return 1;
+}
+
+int json_span_table_init(p_json_span_table t_table)
+{
+	t_table->capacity = 64;
+	t_table->count = 0;
+	t_table->slots = (json_span*)malloc(t_table->capacity * sizeof(json_span));
+	memset(&t_table->root, 0, sizeof(t_table->root));
+	
+	return t_table->slots != 0;
+}
+
+void json_span_table_final(p_json_span_table t_table)
+{
+	free(t_table->slots);
+	t_table->slots = 0;
+	t_table->capacity = 0;
+	t_table->count = 0;
+}
+
+int json_span_table_push(p_json_span_table t_table, const json_blob* t_blob, const json_blob* t_parent, const char* t_text)
+{
+	/* spans are appended as containers open, so loading writes them in order */
+	
+	if (t_table->count == t_table->capacity)
+	{
+		json_span* slots = (json_span*)realloc(t_table->slots, t_table->capacity * 2 * sizeof(json_span));
+		if (!slots)
+		{
+			JSON_LOG("failed to grow span table");
+			return 0;
+		}
+		t_table->slots = slots;
+		t_table->capacity *= 2;
+	}
+	
+	json_span* span = t_table->slots + t_table->count++;
+	span->blob = t_blob;
+	span->parent = t_parent;
+	span->text = t_text;
+	span->length = 0;
+	span->is_dirty = 0;
+	span->is_hashed = 0;
+	return 1;
+}
+
+int json_span_compare(const void* t_a, const void* t_b)
+{
+	const json_blob* a = ((const json_span*)t_a)->blob;
+	const json_blob* b = ((const json_span*)t_b)->blob;
+	
+	return a < b ? -1 : a > b;
+}
+
+void json_span_table_sort(p_json_span_table t_table)
+{
+	/* containers are allocated in the order they open, so this is only needed when the arena's chunks are out of address order */
+	
+	unsigned int i = 1;
+	while (i < t_table->count && t_table->slots[i - 1].blob < t_table->slots[i].blob)
+	{
+		++i;
+	}
+	if (i < t_table->count)
+	{
+		qsort(t_table->slots, t_table->count, sizeof(json_span), json_span_compare);
+	}
+}
+
+json_span* json_span_table_find(const json_span_table* t_table, const json_blob* t_blob)
+{
+	unsigned int low = 0;
+	unsigned int high = t_table->count;
+	
+	while (low < high)
+	{
+		unsigned int middle = low + (high - low) / 2;
+		if (t_table->slots[middle].blob < t_blob)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return low < t_table->count && t_table->slots[low].blob == t_blob ? t_table->slots + low : 0;
+}
+
+const char* json_intern_find(const json_file* t_json, const char* t_key, size_t t_length)
+{
+	assert(t_json && (t_key || !t_length));
+	
+	return t_json->keys.slots ? json_key_table_find(&t_json->keys, t_key, t_length, json_key_hash(t_key, t_length)) : 0;
+}
+
+int json_begin_property(json_file* t_json, p_json_frame t_frame, const json_string* t_name)
+{
+	assert(t_json && t_frame && t_name);
+	
+	JSON_LOG("property \"%.*s\" : ", (int)t_name->size, (char*)t_name->data);
+	
+	/* the name waits on the frame for its value, duplicates are found when the object closes */
+	
+	if (t_name->size > (unsigned int)-1)
+	{
+		JSON_LOG("property name too long");
+		return 0;
+	}
+	
+	const char* key = (const char*)t_name->data;
+	unsigned int hash = json_key_hash(key, t_name->size);
+	
+	if (t_json->keys.slots)
+	{
+		/* repeated names share the first one's characters */
+		
+		const char* interned = json_key_table_find(&t_json->keys, key, t_name->size, hash);
+		
+		if (interned)
+		{
+			key = interned;
+		}
+		else if (!json_key_table_insert(&t_json->keys, key, t_name->size, hash))
+		{
+			return 0;
+		}
+	}
+	
+	t_frame->key = key;
+	t_frame->key_length = (unsigned int)t_name->size;
+	t_frame->hash = hash;
+	
+	return 1;
+}
+
+int json_emit_value(p_vector t_values, p_json_frame t_frame, const json_value* t_value, json_value* t_out_value)
+{
+	assert(t_values && t_value && t_out_value);
+	
+	if (!t_frame)
+	{
+		*t_out_value = *t_value;
+		return 1;
+	}
+	
+	if (t_frame->value.type == json_data_type_array)
+	{
+		return vector_push(t_values, t_value);
+	}
+	
+	json_property property;
+	property.key = t_frame->key;
+	property.key_length = t_frame->key_length;
+	property.hash = t_frame->hash;
+	property.value = *t_value;
+	
+	return vector_push_many(t_values, &property, json_property_slots);
+}
+
+int json_read_value(p_json_cursor t_cursor, json_file * t_json, json_value* t_out_value)
+{
+	assert(t_cursor);
+	assert(t_json);
+	assert(t_out_value);
+	
 	JSON_LOG("begin read value");
 	
 	*t_out_value = json_undefined;
-	char s[64] = {0};
 	
-	if (!json_skip_whitespace(t_file) || !fread(s, 1, 1, t_file))
+	/* containers are tracked on the cursor's frame stack rather than by recursion, so nesting costs heap not stack */
+	
+	unsigned int first_frame = t_cursor->frames.element_count;
+	p_json_frame frame = 0;
+	const char* c = 0;
+	
+json_read_value_next:
+	
+	c = json_peek(t_cursor);
+	if (!c)
+	{
+		JSON_LOG("failed to read first character");
+		goto json_read_value_fail;
+	}
+	
+	json_value value = json_undefined;
+	
+	if (t_cursor->structural == t_cursor->prebuilt)
+	{
+		/* a container already read in parallel */
+		
+		t_cursor->structural = t_cursor->prebuilt_end;
+		if (!json_emit_value(&t_cursor->values, frame, &t_cursor->prebuilt_value, t_out_value))
+		{
+			goto json_read_value_fail;
+		}
+		goto json_read_value_separator;
+	}
+	
+	if (*c == '{' || *c == '[')
+	{
+		if (t_cursor->frames.element_count - first_frame >= t_cursor->max_depth)
+		{
+			JSON_LOG("maximum depth exceeded");
+			goto json_read_value_fail;
+		}
+		
+		json_next(t_cursor);
+		
+		json_frame opened;
+		opened.key = 0;
+		
+		if (!json_alloc_container(t_json, *c, &value))
+		{
+			goto json_read_value_fail;
+		}
+		
+		if (!json_emit_value(&t_cursor->values, frame, &value, t_out_value))
+		{
+			JSON_LOG("failed to open container");
+			goto json_read_value_fail;
+		}
+		
+		opened.value = value;
+		opened.first_value = t_cursor->values.element_count;
+		opened.span = 0;
+		
+		if (t_json->spans.slots)
+		{
+			/* the root's span is kept apart as the file holds a copy of the root */
+			
+			if (!frame)
+			{
+				t_json->spans.root.text = c;
+			}
+			else if (json_span_table_push(&t_json->spans, value.value.blob, t_cursor->frames.element_count - first_frame > 1 ? frame->value.value.blob : 0, c))
+			{
+				opened.span = t_json->spans.count - 1;
+			}
+			else
+			{
+				goto json_read_value_fail;
+			}
+		}
+		
+		if (!vector_push(&t_cursor->frames, &opened))
+		{
+			JSON_LOG("failed to push frame");
+			goto json_read_value_fail;
+		}
+		frame = (p_json_frame)vector_get_index(&t_cursor->frames, t_cursor->frames.element_count - 1);
+		
+		c = json_peek(t_cursor);
+		if (c && (*c == '}' || *c == ']'))
+		{
+			goto json_read_value_close;
+		}
+		if (frame->value.type == json_data_type_object)
+		{
+			goto json_read_value_property;
+		}
+		goto json_read_value_next;
+	}
+	
+	if (!json_read_scalar(t_cursor, t_json, c, &value) || !json_emit_value(&t_cursor->values, frame, &value, t_out_value))
+	{
+		goto json_read_value_fail;
+	}
+	
+json_read_value_separator:
+	
+	if (!frame)
+	{
+		JSON_LOG("succeed read value");
+		return 1;
+	}
+	
+	/* property separator or end of container */
+	
+	c = json_peek(t_cursor);
+	if (!c)
+	{
+		JSON_LOG("unexpected end of container");
+		goto json_read_value_fail;
+	}
+	if (*c == ',')
+	{
+		json_next(t_cursor);
+		if (frame->value.type == json_data_type_object)
+		{
+			goto json_read_value_property;
+		}
+		goto json_read_value_next;
+	}
+	
+json_read_value_close:
+	
+	c = json_next(t_cursor);
+	if (!c || *c != (frame->value.type == json_data_type_object ? '}' : ']'))
+	{
+		JSON_LOG("character is unexpected, fail out");
+		goto json_read_value_fail;
+	}
+	
+	if (!json_close_frame(&t_cursor->values, t_json, frame))
+	{
+		goto json_read_value_fail;
+	}
+	
+	if (t_json->spans.slots)
+	{
+		json_span* span = t_cursor->frames.element_count - first_frame == 1 ? &t_json->spans.root : t_json->spans.slots + frame->span;
+		span->length = (size_t)(c + 1 - span->text);
+	}
+	
+	--t_cursor->frames.element_count;
+	frame = t_cursor->frames.element_count > first_frame ? (p_json_frame)vector_get_index(&t_cursor->frames, t_cursor->frames.element_count - 1) : 0;
+	goto json_read_value_separator;
+	
+json_read_value_property:
+	
+	{
+		/* property name */
+		
+		json_string name;
+		
+		if (!json_read_string(t_cursor, &t_json->arena, &name))
+		{
+			JSON_LOG("failed to read property name");
+			goto json_read_value_fail;
+		}
+		
+		c = json_next(t_cursor);
+		if (!c || *c != ':')
+		{
+			JSON_LOG("failed to read colon");
+			goto json_read_value_fail;
+		}
+		
+		if (!json_begin_property(t_json, frame, &name))
+		{
+			goto json_read_value_fail;
+		}
+		goto json_read_value_next;
+	}
+	
+json_read_value_fail:
+	
+	t_cursor->frames.element_count = first_frame;
+	*t_out_value = json_undefined;
+	return 0;
+}
+
+typedef struct
+{
+	const unsigned int* structural;
+	const unsigned int* structural_end;
+	json_file json;
+	vector names;
+	vector values;
+	int result;
+} json_parallel_part;
+
+typedef struct
+{
+	json_parallel_part* parts;
+	unsigned int part_count;
+	const char* data;
+	const char* end;
+	int is_object;
+	unsigned int max_depth;
+	int exact_integers;
+	int validate_utf8;
+	atomic next_part;
+} json_parallel_work;
+
+int json_parallel_read_part(json_parallel_work* t_work, json_parallel_part* t_part)
+{
+	/* reads a run of the split container's children, with the commas between them */
+	
+	json_cursor cursor;
+	if (!vector_init(&cursor.values, sizeof(json_value)))
+	{
+		return 0;
+	}
+	if (!vector_init(&cursor.frames, sizeof(json_frame)))
+	{
+		vector_final(&cursor.values);
+		return 0;
+	}
+	cursor.data = t_work->data;
+	cursor.end = t_work->end;
+	cursor.structural = t_part->structural;
+	cursor.structural_end = t_part->structural_end;
+	cursor.prebuilt = 0;
+	cursor.max_depth = t_work->max_depth;
+	cursor.exact_integers = t_work->exact_integers;
+	cursor.validate_utf8 = t_work->validate_utf8;
+	
+	int result = 1;
+	while (result)
+	{
+		json_value value;
+		
+		if (t_work->is_object)
+		{
+			json_string name;
+			const char* c = 0;
+			
+			result = json_read_string(&cursor, &t_part->json.arena, &name) && (c = json_next(&cursor)) && *c == ':' && vector_push(&t_part->names, &name);
+		}
+		
+		result = result && json_read_value(&cursor, &t_part->json, &value) && vector_push(&t_part->values, &value);
+		
+		if (!result || cursor.structural == cursor.structural_end)
+		{
+			break;
+		}
+		
+		const char* c = json_next(&cursor);
+		result = c && *c == ',';
+	}
+	
+	vector_final(&cursor.frames);
+	vector_final(&cursor.values);
+	
+	return result;
+}
+
+void json_parallel_worker(void* t_work)
+{
+	json_parallel_work* work = (json_parallel_work*)t_work;
+	unsigned long long int index;
+	
+	while ((index = atomic_increment(&work->next_part)) < work->part_count)
+	{
+		json_parallel_part* part = &work->parts[index];
+		part->result = json_parallel_read_part(work, part);
+	}
+}
+
+int json_find_children(const char* t_data, const unsigned int* t_structurals, unsigned int t_count, unsigned int t_container, p_vector t_out_children, unsigned int* t_out_close)
+{
+	/* records where each child of a container starts by counting brackets, strings hold no brackets so need no care */
+	
+	unsigned int depth = 0;
+	int is_child_next = 1;
+	unsigned int i = t_container + 1;
+	
+	t_out_children->element_count = 0;
+	for (; i < t_count; ++i)
+	{
+		char c = t_data[t_structurals[i]];
+		
+		if (!depth)
+		{
+			if (c == '}' || c == ']')
+			{
+				*t_out_close = i;
+				return 1;
+			}
+			if (c == ',')
+			{
+				is_child_next = 1;
+				continue;
+			}
+			if (is_child_next)
+			{
+				if (!vector_push(t_out_children, &i))
+				{
+					return 0;
+				}
+				is_child_next = 0;
+			}
+		}
+		
+		if (c == '{' || c == '[')
+		{
+			++depth;
+		}
+		else if (c == '}' || c == ']')
+		{
+			--depth;
+		}
+	}
+	return 0;
+}
+
+int json_read_parallel(p_json_cursor t_cursor, json_file* t_json, unsigned int t_thread_count)
+{
+	/* finds the container holding most of the document, reads runs of its children on worker threads into their own arenas, and leaves it on the cursor for json_read_value to pick up */
+	
+	const char* data = t_cursor->data;
+	const unsigned int* structurals = t_cursor->structural;
+	unsigned int count = (unsigned int)(t_cursor->structural_end - t_cursor->structural);
+	unsigned int container = 0;
+	unsigned int close = 0;
+	unsigned int depth = 1;
+	
+	vector children;
+	if (!count || data[structurals[0]] != '{' || !vector_init(&children, sizeof(unsigned int)))
+	{
+		return 0;
+	}
+	
+	for (;;)
+	{
+		if (!json_find_children(data, structurals, count, container, &children, &close))
+		{
+			vector_final(&children);
+			return 0;
+		}
+		
+		/* step into a child holding more than half of its container */
+		
+		const unsigned int* starts = (const unsigned int*)children.buffer.data;
+		unsigned int span = structurals[close] - structurals[container];
+		unsigned int i = 0;
+		for (; i < children.element_count; ++i)
+		{
+			unsigned int child_end = i + 1 < children.element_count ? starts[i + 1] : close;
+			if ((structurals[child_end] - structurals[starts[i]]) * 2 > span)
+			{
+				break;
+			}
+		}
+		
+		unsigned int value = i == children.element_count ? count : data[structurals[container]] == '{' ? starts[i] + 3 : starts[i];
+		if (value >= close || (data[structurals[value]] != '{' && data[structurals[value]] != '['))
+		{
+			break;
+		}
+		container = value;
+		++depth;
+	}
+	
+	/* the close is skipped once the container is prebuilt, so a mismatched one is left for the serial read to report */
+	
+	if (children.element_count < 2 || depth >= t_cursor->max_depth || data[structurals[close]] != (data[structurals[container]] == '{' ? '}' : ']'))
+	{
+		vector_final(&children);
+		return 0;
+	}
+	
+	/* cut the children into several runs per thread of about equal size, so threads that finish early take more */
+	
+	const unsigned int* starts = (const unsigned int*)children.buffer.data;
+	unsigned int part_limit = t_thread_count * 4 < children.element_count ? t_thread_count * 4 : children.element_count;
+	unsigned int part_size = (structurals[close] - structurals[starts[0]]) / part_limit + 1;
+	
+	json_parallel_work work;
+	work.parts = (json_parallel_part*)calloc(part_limit, sizeof(json_parallel_part));
+	work.part_count = 0;
+	work.data = data;
+	work.end = t_cursor->end;
+	work.is_object = data[structurals[container]] == '{';
+	work.max_depth = t_cursor->max_depth - depth;
+	work.exact_integers = t_cursor->exact_integers;
+	work.validate_utf8 = t_cursor->validate_utf8;
+	atomic_init(&work.next_part, 0);
+	
+	int result = work.parts != 0;
+	unsigned int first = 0;
+	unsigned int i = 0;
+	for (; result && i < children.element_count; ++i)
+	{
+		int is_last = i + 1 == children.element_count;
+		if (!is_last && structurals[starts[i + 1]] - structurals[starts[first]] < part_size)
+		{
+			continue;
+		}
+		
+		json_parallel_part* part = &work.parts[work.part_count];
+		part->structural = structurals + starts[first];
+		part->structural_end = structurals + (is_last ? close : starts[i + 1] - 1);
+		if (!arena_init(&part->json.arena, JSON_ARENA_CHUNK_SIZE) || !vector_init(&part->names, sizeof(json_string)) || !vector_init(&part->values, sizeof(json_value)))
+		{
+			vector_final(&part->names);
+			arena_final(&part->json.arena);
+			result = 0;
+			break;
+		}
+		++work.part_count;
+		first = i + 1;
+	}
+	
+	unsigned int thread_count = t_thread_count < work.part_count ? t_thread_count : work.part_count;
+	thread* threads = result && thread_count > 1 ? (thread*)malloc((thread_count - 1) * sizeof(thread)) : 0;
+	unsigned int started = 0;
+	
+	JSON_LOG("reading %u children of structural %u in %u parts", children.element_count, container, work.part_count);
+	
+	for (; threads && started < thread_count - 1; ++started)
+	{
+		if (!thread_init(&threads[started], json_parallel_worker, &work))
+		{
+			JSON_LOG("failed to start thread, continuing with fewer");
+			break;
+		}
+	}
+	if (result)
+	{
+		json_parallel_worker(&work);
+	}
+	for (i = 0; i < started; ++i)
+	{
+		thread_join(&threads[i]);
+		thread_final(&threads[i]);
+	}
+	free(threads);
+	
+	/* stitch the children together in order, the part arenas move to the json file */
+	
+	json_frame frame;
+	frame.key = 0;
+	frame.first_value = t_cursor->values.element_count;
+	result = result && json_alloc_container(t_json, work.is_object ? '{' : '[', &frame.value);
+	
+	unsigned int value_count = 0;
+	for (i = 0; result && i < work.part_count; ++i)
+	{
+		result = work.parts[i].result;
+		value_count += work.parts[i].values.element_count;
+	}
+	
+	json_value* values = result && !work.is_object ? (json_value*)arena_alloc(&t_json->arena, value_count * sizeof(json_value)) : 0;
+	result = result && (work.is_object || values);
+	if (values)
+	{
+		frame.value.value.blob->array.buffer.data = values;
+		frame.value.value.blob->array.buffer.size = value_count * sizeof(json_value);
+		frame.value.value.blob->array.element_count = value_count;
+	}
+	
+	for (i = 0; i < work.part_count; ++i)
+	{
+		json_parallel_part* part = &work.parts[i];
+		unsigned int j = 0;
+		
+		if (result && work.is_object)
+		{
+			for (; result && j < part->values.element_count; ++j)
+			{
+				json_value unused;
+				result = json_begin_property(t_json, &frame, (const json_string*)vector_get_index(&part->names, j))
+					&& json_emit_value(&t_cursor->values, &frame, (const json_value*)vector_get_index(&part->values, j), &unused);
+			}
+		}
+		else if (result)
+		{
+			memcpy(values, part->values.buffer.data, part->values.element_count * sizeof(json_value));
+			values += part->values.element_count;
+		}
+		
+		if (!result || !arena_merge(&t_json->arena, &part->json.arena))
+		{
+			arena_final(&part->json.arena);
+			result = 0;
+		}
+		vector_final(&part->values);
+		vector_final(&part->names);
+	}
+	free(work.parts);
+	
+	if (result && work.is_object)
+	{
+		/* the properties gathered on the cursor's value stack as for any object */
+		
+		result = json_close_frame(&t_cursor->values, t_json, &frame);
+	}
+	t_cursor->values.element_count = frame.first_value;
+	atomic_final(&work.next_part);
+	vector_final(&children);
+	
+	if (!result)
+	{
+		JSON_LOG("failed to read in parallel");
+		return 0;
+	}
+	
+	t_cursor->prebuilt = structurals + container;
+	t_cursor->prebuilt_end = structurals + close + 1;
+	t_cursor->prebuilt_value = frame.value;
+	return 1;
+}
+
+void json_load_options_init(json_load_options* t_options)
+{
+	assert(t_options);
+	
+	t_options->max_depth = JSON_MAX_DEPTH;
+	t_options->thread_count = 0;
+	t_options->exact_integers = 0;
+	t_options->intern_keys = 0;
+	t_options->validate_utf8 = 0;
+	t_options->track_edits = 0;
+}
+
+int json_load_from_buffer_with_options(json_file* t_json, const char* t_data, size_t t_size, const json_load_options* t_options)
+{
+	assert(t_json && (t_data || !t_size) && t_options);
+	
+	JSON_LOG("begin load from buffer");
+	
+	vector structurals;
+	if (!json_scan(t_data, t_size, &structurals))
+	{
+		JSON_LOG("failed to scan structure");
+		return 0;
+	}
+	
+	json_cursor cursor;
+	if (!vector_init(&cursor.values, sizeof(json_value)))
+	{
+		JSON_LOG("failed to init value stack");
+		vector_final(&structurals);
+		return 0;
+	}
+	if (!vector_init(&cursor.frames, sizeof(json_frame)))
+	{
+		JSON_LOG("failed to init frame stack");
+		vector_final(&cursor.values);
+		vector_final(&structurals);
+		return 0;
+	}
+	if (!arena_init(&t_json->arena, JSON_ARENA_CHUNK_SIZE))
+	{
+		JSON_LOG("failed to init arena");
+		vector_final(&cursor.frames);
+		vector_final(&cursor.values);
+		vector_final(&structurals);
+		return 0;
+	}
+	
+	memset(&t_json->keys, 0, sizeof(t_json->keys));
+	if (t_options->intern_keys && !json_key_table_init(&t_json->keys))
+	{
+		JSON_LOG("failed to init key table");
+		arena_final(&t_json->arena);
+		vector_final(&cursor.frames);
+		vector_final(&cursor.values);
+		vector_final(&structurals);
+		return 0;
+	}
+	
+	memset(&t_json->spans, 0, sizeof(t_json->spans));
+	if (t_options->track_edits && !json_span_table_init(&t_json->spans))
+	{
+		JSON_LOG("failed to init span table");
+		json_key_table_final(&t_json->keys);
+		arena_final(&t_json->arena);
+		vector_final(&cursor.frames);
+		vector_final(&cursor.values);
+		vector_final(&structurals);
+		return 0;
+	}
+	
+	t_json->source.data = t_data;
+	t_json->source.size = t_size;
+	t_json->source.is_mapped = 0;
+	t_json->source.is_allocated = 0;
+	
+	cursor.data = t_data;
+	cursor.end = t_data + t_size;
+	cursor.structural = (const unsigned int*)structurals.buffer.data;
+	cursor.structural_end = cursor.structural + structurals.element_count;
+	cursor.prebuilt = 0;
+	cursor.max_depth = t_options->max_depth;
+	cursor.exact_integers = t_options->exact_integers;
+	cursor.validate_utf8 = t_options->validate_utf8;
+	
+	/* large documents read the bulk of their values in parallel, interned keys and tracked edits need the one table so stay serial */
+	
+	unsigned int thread_count = t_options->thread_count ? t_options->thread_count : thread_count_cores();
+	if (thread_count > 1 && t_size >= JSON_PARALLEL_MIN_SIZE && !t_options->intern_keys && !t_options->track_edits)
+	{
+		json_read_parallel(&cursor, t_json, thread_count);
+	}
+	
+	json_value root;
+	
+	int result = json_read_value(&cursor, t_json, &root) && root.type == json_data_type_object && cursor.structural == cursor.structural_end;
+	
+	vector_final(&cursor.frames);
+	vector_final(&cursor.values);
+	vector_final(&structurals);
+	
+	if (!result)
+	{
+		JSON_LOG("failed to read root object or text follows it");
+		json_span_table_final(&t_json->spans);
+		json_key_table_final(&t_json->keys);
+		arena_final(&t_json->arena);
+		return 0;
+	}
+	
+	t_json->root = root.value.blob->object;
+	
+	if (t_json->spans.slots)
+	{
+		json_span_table_sort(&t_json->spans);
+	}
+	
+	JSON_LOG("succeeded load from buffer");
+	
+	return 1;
+}
+
+int json_load_from_buffer(json_file* t_json, const char* t_data, size_t t_size)
+{
+	json_load_options options;
+	json_load_options_init(&options);
+	
+	return json_load_from_buffer_with_options(t_json, t_data, t_size, &options);
+}
+
+int json_load_buffer(json_file* t_json, const buffer* t_buffer)
+{
+	assert(t_json && t_buffer);
+	
+	return json_load_from_buffer(t_json, (const char*)t_buffer->data, t_buffer->size);
+}
+
+int json_load_with_options(json_file* t_json, const char* t_string, const json_load_options* t_options)
+{
+	assert(t_json && t_string && t_options);
+	
+	JSON_LOG("begin load");
+	
+	json_mapping mapping;
+	if (!json_mapping_init(&mapping, t_string))
+	{
+		JSON_LOG("failed to map file");
+		return 0;
+	}
+	
+	if (!json_load_from_buffer_with_options(t_json, mapping.data, mapping.size, t_options))
+	{
+		json_mapping_final(&mapping);
+		return 0;
+	}
+	
+	/* strings refer to the mapping, so it now belongs to the json file */
+	
+	t_json->source = mapping;
+	
+	JSON_LOG("succeeded load");
+	
+	return 1;
+}
+
+int json_load(json_file* t_json, const char* t_string)
+{
+	json_load_options options;
+	json_load_options_init(&options);
+	
+	return json_load_with_options(t_json, t_string, &options);
+}
+
+void json_final(json_file* t_json)
+{
+	assert(t_json);
+	
+	json_span_table_final(&t_json->spans);
+	json_key_table_final(&t_json->keys);
+	arena_final(&t_json->arena);
+	json_mapping_final(&t_json->source);
+}
+
+int json_init(json_file* t_json)
+{
+	assert(t_json);
+	
+	memset(t_json, 0, sizeof(*t_json));
+	if (!arena_init(&t_json->arena, JSON_ARENA_CHUNK_SIZE))
+	{
+		JSON_LOG("failed to init arena");
+		return 0;
+	}
+	
+	json_value root;
+	if (!json_alloc_container(t_json, '{', &root))
+	{
+		arena_final(&t_json->arena);
+		return 0;
+	}
+	t_json->root = root.value.blob->object;
+	
+	return 1;
+}
+
+json_value json_root(json_file* t_json)
+{
+	assert(t_json);
+	
+	json_value root;
+	root.type = json_data_type_object;
+	root.value.blob = (p_json_blob)&t_json->root;
+	return root;
+}
+
+void json_mark_blob_edited(json_file* t_json, const json_blob* t_blob)
+{
+	/* containers that were not in the text were placed by an edit that marked their holders, and marked containers that are not hashed had their holders marked with them */
+	
+	if (!t_json->spans.slots)
+	{
+		return;
+	}
+	
+	while (t_blob && t_blob != (const json_blob*)&t_json->root)
+	{
+		json_span* span = json_span_table_find(&t_json->spans, t_blob);
+		if (!span || (span->is_dirty && !span->is_hashed))
+		{
+			return;
+		}
+		span->is_dirty = 1;
+		span->is_hashed = 0;
+		t_blob = span->parent;
+	}
+	t_json->spans.root.is_dirty = 1;
+	t_json->spans.root.is_hashed = 0;
+}
+
+void json_adopt(json_file* t_json, const json_blob* t_holder, const json_value* t_value)
+{
+	/* a container from the text placed by an edit now belongs to its new holder */
+	
+	if (t_json->spans.slots && (t_value->type == json_data_type_object || t_value->type == json_data_type_array))
+	{
+		json_span* span = json_span_table_find(&t_json->spans, t_value->value.blob);
+		if (span)
+		{
+			span->parent = t_holder != (const json_blob*)&t_json->root ? t_holder : 0;
+		}
+	}
+}
+
+void json_mark_edited(json_file* t_json, const json_value* t_container)
+{
+	assert(t_json && t_container && (t_container->type == json_data_type_object || t_container->type == json_data_type_array));
+	
+	json_mark_blob_edited(t_json, t_container->value.blob);
+}
+
+int json_make_object(json_file* t_json, json_value* t_out_value)
+{
+	assert(t_json && t_out_value);
+	
+	return json_alloc_container(t_json, '{', t_out_value);
+}
+
+int json_make_array(json_file* t_json, json_value* t_out_value)
+{
+	assert(t_json && t_out_value);
+	
+	return json_alloc_container(t_json, '[', t_out_value);
+}
+
+int json_make_string(json_file* t_json, const char* t_string, size_t t_length, json_value* t_out_value)
+{
+	assert(t_json && (t_string || !t_length) && t_out_value);
+	
+	json_string* string = (json_string*)arena_alloc(&t_json->arena, sizeof(json_string) + t_length + 1);
+	
+	if (!string)
+	{
+		JSON_LOG("failed to allocate string");
+		return 0;
+	}
+	
+	char* data = (char*)(string + 1);
+	memcpy(data, t_string, t_length);
+	data[t_length] = '\0';
+	string->data = data;
+	string->size = t_length;
+	
+	t_out_value->type = json_data_type_string;
+	t_out_value->value.blob = (p_json_blob)string;
+	return 1;
+}
+
+int json_object_set(json_file* t_json, const json_value* t_object, const char* t_key, size_t t_length, const json_value* t_value)
+{
+	assert(t_json && t_object && t_object->type == json_data_type_object && (t_key || !t_length) && t_value);
+	
+	json_object* object = &t_object->value.blob->object;
+	json_property* property = t_length <= (unsigned int)-1 ? json_object_lookup(object, t_key, 0, (unsigned int)t_length, json_key_hash(t_key, t_length)) : 0;
+	
+	if (property)
+	{
+		property->value = *t_value;
+		json_adopt(t_json, t_object->value.blob, t_value);
+		json_mark_blob_edited(t_json, t_object->value.blob);
+		return 1;
+	}
+	
+	/* the name is copied so the caller's need not outlive the file */
+	
+	char* key = (char*)arena_alloc(&t_json->arena, t_length + 1);
+	
+	if (!key)
+	{
+		JSON_LOG("failed to allocate property name");
+		return 0;
+	}
+	
+	memcpy(key, t_key, t_length);
+	key[t_length] = '\0';
+	
+	json_string name;
+	name.data = key;
+	name.size = t_length;
+	
+	json_frame frame;
+	frame.value = *t_object;
+	frame.key = 0;
+	frame.first_value = 0;
+	
+	if (!json_begin_property(t_json, &frame, &name))
+	{
+		return 0;
+	}
+	
+	unsigned int count = object->properties.element_count;
+	
+	if ((count + 1) * sizeof(json_property) > object->properties.buffer.size)
+	{
+		/* as with arrays, properties move to a buffer twice the size and the old one stays in the arena */
+		
+		size_t size = (count ? count * 2 : 4) * sizeof(json_property);
+		void* data = arena_alloc(&t_json->arena, size);
+		
+		if (!data)
+		{
+			JSON_LOG("failed to grow object");
+			return 0;
+		}
+		
+		if (count)
+		{
+			memcpy(data, object->properties.buffer.data, count * sizeof(json_property));
+		}
+		object->properties.buffer.data = data;
+		object->properties.buffer.size = size;
+	}
+	
+	property = (json_property*)object->properties.buffer.data + count;
+	property->key = frame.key;
+	property->key_length = frame.key_length;
+	property->hash = frame.hash;
+	property->value = *t_value;
+	object->properties.element_count = ++count;
+	
+	/* the index takes the new property while it stays at most half full, and is rebuilt twice the size when it would not */
+	
+	if (object->index && count * 2 <= object->index_capacity)
+	{
+		unsigned int mask = object->index_capacity - 1;
+		unsigned int slot = property->hash & mask;
+		while (object->index[slot])
+		{
+			slot = (slot + 1) & mask;
+		}
+		object->index[slot] = count;
+	}
+	else if (count >= JSON_OBJECT_INDEX_MIN && !json_object_index(&t_json->arena, object, json_object_index_capacity(count)))
+	{
+		--object->properties.element_count;
+		return 0;
+	}
+	
+	json_adopt(t_json, t_object->value.blob, t_value);
+	json_mark_blob_edited(t_json, t_object->value.blob);
+	return 1;
+}
+
+int json_object_remove(json_file* t_json, const json_value* t_object, const char* t_key, size_t t_length)
+{
+	assert(t_json && t_object && t_object->type == json_data_type_object && (t_key || !t_length));
+	
+	json_object* object = &t_object->value.blob->object;
+	json_property* property = t_length <= (unsigned int)-1 ? json_object_lookup(object, t_key, 0, (unsigned int)t_length, json_key_hash(t_key, t_length)) : 0;
+	
+	if (!property)
+	{
+		JSON_LOG("no property to remove");
+		return 0;
+	}
+	
+	/* later properties move down to keep their order, so the index is rebuilt where it is */
+	
+	json_property* end = (json_property*)object->properties.buffer.data + object->properties.element_count;
+	memmove(property, property + 1, (size_t)(end - property - 1) * sizeof(json_property));
+	--object->properties.element_count;
+	
+	if (object->index)
+	{
+		json_object_index(&t_json->arena, object, object->index_capacity);
+	}
+	
+	json_mark_blob_edited(t_json, t_object->value.blob);
+	return 1;
+}
+
+int json_array_insert(json_file* t_json, const json_value* t_array, unsigned int t_index, const json_value* t_value)
+{
+	assert(t_json && t_array && t_array->type == json_data_type_array && t_value);
+	
+	json_array* array = &t_array->value.blob->array;
+	
+	if (t_index > array->element_count)
+	{
+		JSON_LOG("index past end of array");
+		return 0;
+	}
+	
+	if ((array->element_count + 1) * sizeof(json_value) > array->buffer.size)
+	{
+		/* loaded arrays have no room to spare, entries move to a buffer twice the size and the old one stays in the arena */
+		
+		size_t size = (array->element_count ? array->element_count * 2 : 4) * sizeof(json_value);
+		void* data = arena_alloc(&t_json->arena, size);
+		
+		if (!data)
+		{
+			JSON_LOG("failed to grow array");
+			return 0;
+		}
+		
+		if (array->element_count)
+		{
+			memcpy(data, array->buffer.data, array->element_count * sizeof(json_value));
+		}
+		array->buffer.data = data;
+		array->buffer.size = size;
+	}
+	
+	json_value* values = (json_value*)array->buffer.data;
+	memmove(values + t_index + 1, values + t_index, (array->element_count - t_index) * sizeof(json_value));
+	values[t_index] = *t_value;
+	++array->element_count;
+	
+	json_adopt(t_json, t_array->value.blob, t_value);
+	json_mark_blob_edited(t_json, t_array->value.blob);
+	return 1;
+}
+
+int json_array_append(json_file* t_json, const json_value* t_array, const json_value* t_value)
+{
+	assert(t_json && t_array && t_array->type == json_data_type_array && t_value);
+	
+	return json_array_insert(t_json, t_array, t_array->value.blob->array.element_count, t_value);
+}
+
+int json_array_set(json_file* t_json, const json_value* t_array, unsigned int t_index, const json_value* t_value)
+{
+	assert(t_json && t_array && t_array->type == json_data_type_array && t_value);
+	
+	json_array* array = &t_array->value.blob->array;
+	
+	if (t_index >= array->element_count)
+	{
+		JSON_LOG("index past end of array");
+		return 0;
+	}
+	
+	((json_value*)array->buffer.data)[t_index] = *t_value;
+	json_adopt(t_json, t_array->value.blob, t_value);
+	json_mark_blob_edited(t_json, t_array->value.blob);
+	return 1;
+}
+
+int json_array_remove(json_file* t_json, const json_value* t_array, unsigned int t_index)
+{
+	assert(t_json && t_array && t_array->type == json_data_type_array);
+	
+	json_array* array = &t_array->value.blob->array;
+	
+	if (t_index >= array->element_count)
+	{
+		JSON_LOG("index past end of array");
+		return 0;
+	}
+	
+	json_value* values = (json_value*)array->buffer.data;
+	memmove(values + t_index, values + t_index + 1, (array->element_count - t_index - 1) * sizeof(json_value));
+	--array->element_count;
+	
+	json_mark_blob_edited(t_json, t_array->value.blob);
+	return 1;
+}
+
+int json_copy_value(json_file* t_json, const json_value* t_value, json_value* t_out_value)
+{
+	assert(t_json && t_value && t_out_value);
+	
+	if (t_value->type == json_data_type_string)
+	{
+		const json_string* string = &t_value->value.blob->string;
+		return json_make_string(t_json, (const char*)string->data, string->size, t_out_value);
+	}
+	if (t_value->type == json_data_type_array)
+	{
+		const json_array* array = &t_value->value.blob->array;
+		
+		if (!json_make_array(t_json, t_out_value))
+		{
+			return 0;
+		}
+		
+		unsigned int i = 0;
+		for (; i < array->element_count; ++i)
+		{
+			json_value copy;
+			if (!json_copy_value(t_json, (const json_value*)array->buffer.data + i, &copy) || !json_array_append(t_json, t_out_value, &copy))
+			{
+				return 0;
+			}
+		}
+		return 1;
+	}
+	if (t_value->type == json_data_type_object)
+	{
+		const json_object* object = &t_value->value.blob->object;
+		
+		if (!json_make_object(t_json, t_out_value))
+		{
+			return 0;
+		}
+		
+		unsigned int i = 0;
+		for (; i < object->properties.element_count; ++i)
+		{
+			const json_property* property = (const json_property*)object->properties.buffer.data + i;
+			json_value copy;
+			if (!json_copy_value(t_json, &property->value, &copy) || !json_object_set(t_json, t_out_value, property->key, property->key_length, &copy))
+			{
+				return 0;
+			}
+		}
+		return 1;
+	}
+	
+	*t_out_value = *t_value;
+	return 1;
+}
+
+json_value* json_object_find(const json_value* t_object, const char* t_key, size_t t_length)
+{
+	assert(t_object && t_object->type == json_data_type_object && (t_key || !t_length));
+	
+	json_property* property = t_length <= (unsigned int)-1 ? json_object_lookup(&t_object->value.blob->object, t_key, 0, (unsigned int)t_length, json_key_hash(t_key, t_length)) : 0;
+	
+	return property ? &property->value : 0;
+}
+
+int json_number_is_integer(json_number t_number)
+{
+	return t_number >= -9223372036854775808.0 && t_number < 9223372036854775808.0 && t_number == (json_number)(json_integer)t_number;
+}
+
+int json_equals(const json_value* t_a, const json_value* t_b)
+{
+	assert(t_a && t_b);
+	
+	/* numbers compare by value whether or not they were kept as exact integers */
+	
+	if (t_a->type != t_b->type)
+	{
+		if (t_a->type == json_data_type_integer && t_b->type == json_data_type_number)
+		{
+			return json_number_is_integer(t_b->value.number) && (json_integer)t_b->value.number == t_a->value.integer;
+		}
+		if (t_a->type == json_data_type_number && t_b->type == json_data_type_integer)
+		{
+			return json_number_is_integer(t_a->value.number) && (json_integer)t_a->value.number == t_b->value.integer;
+		}
+		return 0;
+	}
+	
+	switch (t_a->type)
+	{
+	case json_data_type_boolean:
+		return !t_a->value.boolean == !t_b->value.boolean;
+	case json_data_type_number:
+		return t_a->value.number == t_b->value.number;
+	case json_data_type_integer:
+		return t_a->value.integer == t_b->value.integer;
+	case json_data_type_string:
+	{
+		const json_string* a = &t_a->value.blob->string;
+		const json_string* b = &t_b->value.blob->string;
+		return a->size == b->size && !memcmp(a->data, b->data, a->size);
+	}
+	case json_data_type_array:
+	{
+		const json_array* a = &t_a->value.blob->array;
+		const json_array* b = &t_b->value.blob->array;
+		
+		if (a == b)
+		{
+			return 1;
+		}
+		if (a->element_count != b->element_count)
+		{
+			return 0;
+		}
+		
+		unsigned int i = 0;
+		for (; i < a->element_count; ++i)
+		{
+			if (!json_equals((const json_value*)a->buffer.data + i, (const json_value*)b->buffer.data + i))
+			{
+				return 0;
+			}
+		}
+		return 1;
+	}
+	case json_data_type_object:
+	{
+		if (t_a->value.blob == t_b->value.blob)
+		{
+			return 1;
+		}
+		
+		const json_object* a = &t_a->value.blob->object;
+		const json_object* b = &t_b->value.blob->object;
+		
+		if (a->properties.element_count != b->properties.element_count)
+		{
+			return 0;
+		}
+		
+		unsigned int i = 0;
+		for (; i < a->properties.element_count; ++i)
+		{
+			const json_property* property = (const json_property*)a->properties.buffer.data + i;
+			const json_property* other = json_object_lookup(b, property->key, 0, property->key_length, property->hash);
+			
+			if (!other || !json_equals(&property->value, &other->value))
+			{
+				return 0;
+			}
+		}
+		return 1;
+	}
+	default:
+		return 1;
+	}
+}
+
+unsigned long long int json_hash_mix(unsigned long long int t_x)
+{
+	t_x ^= t_x >> 33;
+	t_x *= 0xff51afd7ed558ccdULL;
+	t_x ^= t_x >> 33;
+	t_x *= 0xc4ceb9fe1a85ec53ULL;
+	t_x ^= t_x >> 33;
+	return t_x;
+}
+
+unsigned long long int json_hash_bytes(const char* t_data, size_t t_size, unsigned long long int t_seed)
+{
+	/* words are read little endian so hashes are the same on every machine */
+	
+	const unsigned char* c = (const unsigned char*)t_data;
+	unsigned long long int hash = t_seed ^ ((unsigned long long int)t_size * 0x9e3779b97f4a7c15ULL);
+	
+	for (; t_size >= 8; t_size -= 8, c += 8)
+	{
+		unsigned long long int word = (unsigned long long int)c[0] | (unsigned long long int)c[1] << 8 | (unsigned long long int)c[2] << 16 | (unsigned long long int)c[3] << 24
+			| (unsigned long long int)c[4] << 32 | (unsigned long long int)c[5] << 40 | (unsigned long long int)c[6] << 48 | (unsigned long long int)c[7] << 56;
+		hash = json_hash_mix(hash ^ word);
+	}
+	
+	unsigned long long int word = 0;
+	unsigned int shift = 0;
+	for (; t_size; --t_size, shift += 8)
+	{
+		word |= (unsigned long long int)*c++ << shift;
+	}
+	return json_hash_mix(hash ^ word);
+}
+
+unsigned long long int json_hash_value(json_file* t_json, const json_value* t_value, int* t_out_is_tracked)
+{
+	/* a container's hash is kept in its span when every container under it came from the text, edits clear it on the way to the root */
+	
+	*t_out_is_tracked = 1;
+	
+	switch (t_value->type)
+	{
+	case json_data_type_null:
+		return 0x6e756c6c6e756c6cULL;
+	case json_data_type_boolean:
+		return json_hash_mix(0x626f6f6c65616e00ULL | !!t_value->value.boolean);
+	case json_data_type_number:
+	{
+		/* integral doubles hash as the integer they equal */
+		
+		json_number number = t_value->value.number;
+		unsigned long long int bits = 0;
+		
+		if (json_number_is_integer(number))
+		{
+			return json_hash_mix((unsigned long long int)(json_integer)number ^ 0x696e746567657200ULL);
+		}
+		memcpy(&bits, &number, sizeof(bits));
+		return json_hash_mix(bits ^ 0x6e756d6265720000ULL);
+	}
+	case json_data_type_integer:
+		return json_hash_mix((unsigned long long int)t_value->value.integer ^ 0x696e746567657200ULL);
+	case json_data_type_string:
+		return json_hash_bytes((const char*)t_value->value.blob->string.data, t_value->value.blob->string.size, 0x737472696e670000ULL);
+	case json_data_type_array:
+	case json_data_type_object:
+		break;
+	default:
+		return 0;
+	}
+	
+	json_span* span = 0;
+	if (t_json && t_json->spans.slots)
+	{
+		span = t_value->value.blob == (const json_blob*)&t_json->root ? &t_json->spans.root : json_span_table_find(&t_json->spans, t_value->value.blob);
+		if (span && span->is_hashed)
+		{
+			return span->hash;
+		}
+	}
+	
+	int is_tracked = span != 0;
+	int is_child_tracked = 0;
+	unsigned long long int hash = 0;
+	
+	if (t_value->type == json_data_type_array)
+	{
+		/* arrays hash in order */
+		
+		const json_array* array = &t_value->value.blob->array;
+		hash = 0x6172726179000000ULL;
+		
+		unsigned int i = 0;
+		for (; i < array->element_count; ++i)
+		{
+			hash = json_hash_mix(hash ^ json_hash_value(t_json, (const json_value*)array->buffer.data + i, &is_child_tracked));
+			is_tracked = is_tracked && is_child_tracked;
+		}
+		hash = json_hash_mix(hash ^ array->element_count);
+	}
+	else
+	{
+		/* members are summed so their order does not matter */
+		
+		const json_object* object = &t_value->value.blob->object;
+		unsigned long long int sum = 0;
+		
+		unsigned int i = 0;
+		for (; i < object->properties.element_count; ++i)
+		{
+			const json_property* property = (const json_property*)object->properties.buffer.data + i;
+			unsigned long long int value = json_hash_value(t_json, &property->value, &is_child_tracked);
+			sum += json_hash_mix(json_hash_bytes(property->key, property->key_length, 0x6b65790000000000ULL) + json_hash_mix(value ^ 0x76616c7565000000ULL));
+			is_tracked = is_tracked && is_child_tracked;
+		}
+		hash = json_hash_mix(sum ^ json_hash_mix(0x6f626a6563740000ULL ^ object->properties.element_count));
+	}
+	
+	if (is_tracked)
+	{
+		span->hash = hash;
+		span->is_hashed = 1;
+	}
+	*t_out_is_tracked = is_tracked;
+	return hash;
+}
+
+unsigned long long int json_hash(const json_value* t_value)
+{
+	assert(t_value);
+	
+	int is_tracked = 0;
+	return json_hash_value(0, t_value, &is_tracked);
+}
+
+unsigned long long int json_hash_in(json_file* t_json, const json_value* t_value)
+{
+	assert(t_json && t_value);
+	
+	int is_tracked = 0;
+	return json_hash_value(t_json, t_value, &is_tracked);
+}
+
+int json_merge_patch_object(json_file* t_json, const json_value* t_target, const json_value* t_patch)
+{
+	/* each name of the patch is looked up once, nulls remove, objects merge and anything else replaces */
+	
+	const json_object* patch = &t_patch->value.blob->object;
+	
+	unsigned int i = 0;
+	for (; i < patch->properties.element_count; ++i)
+	{
+		const json_property* property = (const json_property*)patch->properties.buffer.data + i;
+		const json_value* value = &property->value;
+		
+		if (value->type == json_data_type_null)
+		{
+			json_object_remove(t_json, t_target, property->key, property->key_length);
+			continue;
+		}
+		
+		if (value->type == json_data_type_object)
+		{
+			json_value* existing = json_object_find(t_target, property->key, property->key_length);
+			json_value child;
+			
+			if (existing && existing->type == json_data_type_object)
+			{
+				child = *existing;
+			}
+			else if (!json_make_object(t_json, &child) || !json_object_set(t_json, t_target, property->key, property->key_length, &child))
+			{
+				return 0;
+			}
+			
+			if (!json_merge_patch_object(t_json, &child, value))
+			{
+				return 0;
+			}
+			continue;
+		}
+		
+		json_value copy;
+		if (!json_copy_value(t_json, value, &copy) || !json_object_set(t_json, t_target, property->key, property->key_length, &copy))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int json_merge_patch(json_file* t_json, const json_value* t_patch)
+{
+	assert(t_json && t_patch);
+	
+	JSON_LOG("begin merge patch");
+	
+	if (t_patch->type != json_data_type_object)
+	{
+		JSON_LOG("merge patch of a root must be an object");
+		return 0;
+	}
+	
+	json_value root = json_root(t_json);
+	return json_merge_patch_object(t_json, &root, t_patch);
+}
+
+int json_pointer_index(const vector* t_token, unsigned int t_count, unsigned int* t_out_index)
+{
+	/* array indices are decimal without leading zeros, "-" is one past the end */
+	
+	const char* c = (const char*)t_token->buffer.data;
+	unsigned int length = t_token->element_count;
+	
+	if (length == 1 && *c == '-')
+	{
+		*t_out_index = t_count;
+		return 1;
+	}
+	if (!length || length > 10 || (length > 1 && *c == '0'))
+	{
+		return 0;
+	}
+	
+	unsigned long long int index = 0;
+	unsigned int i = 0;
+	for (; i < length; ++i)
+	{
+		if (!is_digit(c[i]))
+		{
+			return 0;
+		}
+		index = index * 10 + (unsigned long long int)(c[i] - '0');
+	}
+	if (index > t_count)
+	{
+		return 0;
+	}
+	*t_out_index = (unsigned int)index;
+	return 1;
+}
+
+int json_pointer_resolve(json_value* t_root, const json_value* t_pointer, p_vector t_token, json_value** t_out_parent, json_value** t_out_value)
+{
+	/* walks an rfc 6901 pointer, leaving its last token decoded in t_token along with the container holding it, the value is 0 when it does not exist yet */
+	
+	if (!t_pointer || t_pointer->type != json_data_type_string)
+	{
+		JSON_LOG("pointer is not a string");
+		return 0;
+	}
+	
+	const char* c = (const char*)t_pointer->value.blob->string.data;
+	const char* end = c + t_pointer->value.blob->string.size;
+	json_value* parent = 0;
+	json_value* value = t_root;
+	
+	t_token->element_count = 0;
+	while (c != end)
+	{
+		if (*c++ != '/' || !value)
+		{
+			JSON_LOG("pointer is not valid");
+			return 0;
+		}
+		
+		t_token->element_count = 0;
+		for (; c != end && *c != '/'; ++c)
+		{
+			char decoded = *c;
+			if (decoded == '~')
+			{
+				if (++c == end || (*c != '0' && *c != '1'))
+				{
+					JSON_LOG("pointer escape is not valid");
+					return 0;
+				}
+				decoded = *c == '0' ? '~' : '/';
+			}
+			if (!vector_push(t_token, &decoded))
+			{
+				return 0;
+			}
+		}
+		
+		parent = value;
+		if (parent->type == json_data_type_object)
+		{
+			value = json_object_find(parent, (const char*)t_token->buffer.data, t_token->element_count);
+		}
+		else if (parent->type == json_data_type_array)
+		{
+			const json_array* array = &parent->value.blob->array;
+			unsigned int index = 0;
+			value = json_pointer_index(t_token, array->element_count, &index) && index < array->element_count ? (json_value*)array->buffer.data + index : 0;
+		}
+		else
+		{
+			JSON_LOG("pointer goes through a value that is not a container");
+			return 0;
+		}
+	}
+	
+	*t_out_parent = parent;
+	*t_out_value = value;
+	return 1;
+}
+
+#define json_patch_undo_set 0
+#define json_patch_undo_insert 1
+#define json_patch_undo_remove 2
+#define json_patch_undo_root 3
+
+/* one edit made by a json patch, as much as it takes to reverse it: the element that was at a position of a container and the container's header, which for an array is its vector, or the root before it was replaced */
+
+typedef struct
+{
+	unsigned int kind;
+	unsigned int index;
+	json_value container;
+	json_property element;
+	json_object header;
+} json_patch_undo, *p_json_patch_undo;
+
+int json_patch_record(const json_file* t_json, p_vector t_undo, unsigned int t_kind, const json_value* t_container, unsigned int t_index)
+{
+	/* recorded before the edit, which drops the record again if it fails */
+	
+	json_patch_undo undo;
+	memset(&undo, 0, sizeof(undo));
+	undo.kind = t_kind;
+	undo.index = t_index;
+	undo.header = t_json->root;
+	if (t_container)
+	{
+		undo.container = *t_container;
+		if (t_container->type == json_data_type_object)
+		{
+			undo.header = t_container->value.blob->object;
+		}
+		else
+		{
+			undo.header.properties = t_container->value.blob->array;
+		}
+	}
+	
+	if (t_kind == json_patch_undo_set || t_kind == json_patch_undo_remove)
+	{
+		if (t_container->type == json_data_type_object)
+		{
+			undo.element = ((const json_property*)t_container->value.blob->object.properties.buffer.data)[t_index];
+		}
+		else
+		{
+			undo.element.value = ((const json_value*)t_container->value.blob->array.buffer.data)[t_index];
+		}
+	}
+	
+	if (!vector_push(t_undo, &undo))
+	{
+		JSON_LOG("failed to record patch edit");
+		return 0;
+	}
+	return 1;
+}
+
+void json_patch_undo_edits(json_file* t_json, p_vector t_undo)
+{
+	/* edits are reversed newest first so each finds its container as the edit left it, containers they marked stay marked which only costs the verbatim writer their text */
+	
+	while (t_undo->element_count)
+	{
+		const json_patch_undo* undo = (const json_patch_undo*)t_undo->buffer.data + --t_undo->element_count;
+		
+		if (undo->kind == json_patch_undo_root)
+		{
+			t_json->root = undo->header;
+			continue;
+		}
+		
+		int is_object = undo->container.type == json_data_type_object;
+		json_object* object = &undo->container.value.blob->object;
+		vector* items = is_object ? &object->properties : &undo->container.value.blob->array;
+		size_t size = is_object ? sizeof(json_property) : sizeof(json_value);
+		char* item = (char*)items->buffer.data + undo->index * size;
+		
+		if (undo->kind == json_patch_undo_insert)
+		{
+			/* an insert that outgrew its container left the old buffer and index as they were, so they are taken back and pointers into them stay good */
+			
+			if (items->buffer.data == undo->header.properties.buffer.data)
+			{
+				memmove(item, item + size, (items->element_count - undo->index - 1) * size);
+			}
+			*items = undo->header.properties;
+			if (is_object)
+			{
+				object->index = undo->header.index;
+				object->index_capacity = undo->header.index_capacity;
+			}
+		}
+		else
+		{
+			/* a removal left its space at the end of the container */
+			
+			if (undo->kind == json_patch_undo_remove)
+			{
+				memmove(item + size, item, (items->element_count - undo->index) * size);
+				++items->element_count;
+			}
+			memcpy(item, is_object ? (const void*)&undo->element : (const void*)&undo->element.value, size);
+			json_adopt(t_json, undo->container.value.blob, is_object ? &((const json_property*)item)->value : (const json_value*)item);
+		}
+		
+		if (is_object && undo->kind != json_patch_undo_set && object->index)
+		{
+			json_object_index(&t_json->arena, object, object->index_capacity);
+		}
+	}
+}
+
+int json_patch_add(json_file* t_json, p_vector t_undo, json_value* t_parent, const vector* t_token, const json_value* t_value)
+{
+	const char* key = (const char*)t_token->buffer.data;
+	unsigned int length = t_token->element_count;
+	int result = 0;
+	
+	if (!t_parent)
+	{
+		/* replacing the whole document keeps the root an object */
+		
+		json_value root;
+		if (t_value->type != json_data_type_object)
+		{
+			JSON_LOG("root must stay an object");
+			return 0;
+		}
+		
+		/* copied so that no container from the text is held by the root's copy of the object */
+		
+		if (!json_copy_value(t_json, t_value, &root) || !json_patch_record(t_json, t_undo, json_patch_undo_root, 0, 0))
+		{
+			return 0;
+		}
+		t_json->root = root.value.blob->object;
+		json_mark_blob_edited(t_json, (const json_blob*)&t_json->root);
+		return 1;
+	}
+	if (t_parent->type == json_data_type_object)
+	{
+		/* a name already held is replaced where it is, a new one is appended */
+		
+		json_object* object = &t_parent->value.blob->object;
+		const json_property* property = json_object_lookup(object, key, 0, length, json_key_hash(key, length));
+		unsigned int index = property ? (unsigned int)(property - (const json_property*)object->properties.buffer.data) : object->properties.element_count;
+		
+		if (!json_patch_record(t_json, t_undo, property ? json_patch_undo_set : json_patch_undo_insert, t_parent, index))
+		{
+			return 0;
+		}
+		result = json_object_set(t_json, t_parent, key, length, t_value);
+	}
+	else
+	{
+		unsigned int index = 0;
+		if (!json_pointer_index(t_token, t_parent->value.blob->array.element_count, &index))
+		{
+			JSON_LOG("array index is not valid");
+			return 0;
+		}
+		if (!json_patch_record(t_json, t_undo, json_patch_undo_insert, t_parent, index))
+		{
+			return 0;
+		}
+		result = json_array_insert(t_json, t_parent, index, t_value);
+	}
+	
+	if (!result)
+	{
+		--t_undo->element_count;
+	}
+	return result;
+}
+
+int json_patch_remove(json_file* t_json, p_vector t_undo, json_value* t_parent, const vector* t_token, const json_value* t_value)
+{
+	if (!t_parent || !t_value)
+	{
+		JSON_LOG("nothing to remove");
+		return 0;
+	}
+	
+	/* an object's value is its property's, so the property's position follows from it */
+	
+	int is_object = t_parent->type == json_data_type_object;
+	unsigned int index = is_object
+		? (unsigned int)((const json_property*)((const char*)t_value - offsetof(json_property, value)) - (const json_property*)t_parent->value.blob->object.properties.buffer.data)
+		: (unsigned int)(t_value - (const json_value*)t_parent->value.blob->array.buffer.data);
+	
+	if (!json_patch_record(t_json, t_undo, json_patch_undo_remove, t_parent, index))
+	{
+		return 0;
+	}
+	if (!(is_object ? json_object_remove(t_json, t_parent, (const char*)t_token->buffer.data, t_token->element_count) : json_array_remove(t_json, t_parent, index)))
+	{
+		--t_undo->element_count;
+		return 0;
+	}
+	return 1;
+}
+
+int json_patch_operation(json_file* t_json, const json_value* t_operation, p_vector t_token, p_vector t_undo)
+{
+	if (t_operation->type != json_data_type_object)
+	{
+		JSON_LOG("operation is not an object");
+		return 0;
+	}
+	
+	const json_value* op = json_object_find(t_operation, "op", 2);
+	const json_value* value = json_object_find(t_operation, "value", 5);
+	const json_string* name = op && op->type == json_data_type_string ? &op->value.blob->string : 0;
+	
+	json_value root = json_root(t_json);
+	json_value* parent = 0;
+	json_value* target = 0;
+	json_value copy;
+	
+	if (!name)
+	{
+		JSON_LOG("operation has no op");
+		return 0;
+	}
+
+#define json_patch_is(t_name) (name->size == sizeof(t_name) - 1 && !memcmp(name->data, t_name, sizeof(t_name) - 1))
+	
+	if (json_patch_is("move") || json_patch_is("copy"))
+	{
+		/* the value is taken from where it was before the destination is found, as removing it may shift indices */
+		
+		const json_value* from = json_object_find(t_operation, "from", 4);
+		const json_value* path = json_object_find(t_operation, "path", 4);
+		
+		if (!json_pointer_resolve(&root, from, t_token, &parent, &target) || !target || !path || path->type != json_data_type_string)
+		{
+			JSON_LOG("operation has no value to take");
+			return 0;
+		}
+		
+		if (json_patch_is("copy"))
+		{
+			if (!json_copy_value(t_json, target, &copy))
+			{
+				return 0;
+			}
+		}
+		else
+		{
+			const json_string* from_string = &from->value.blob->string;
+			const json_string* path_string = &path->value.blob->string;
+			
+			if (path_string->size > from_string->size && !memcmp(path_string->data, from_string->data, from_string->size) && ((const char*)path_string->data)[from_string->size] == '/')
+			{
+				JSON_LOG("cannot move a value into itself");
+				return 0;
+			}
+			
+			copy = *target;
+			if (!json_patch_remove(t_json, t_undo, parent, t_token, target))
+			{
+				return 0;
+			}
+		}
+		
+		return json_pointer_resolve(&root, path, t_token, &parent, &target) && json_patch_add(t_json, t_undo, parent, t_token, &copy);
+	}
+	
+	if (!json_pointer_resolve(&root, json_object_find(t_operation, "path", 4), t_token, &parent, &target))
+	{
+		return 0;
+	}
+	
+	if (json_patch_is("test"))
+	{
+		return value && target && json_equals(target, value);
+	}
+	if (json_patch_is("remove"))
+	{
+		return json_patch_remove(t_json, t_undo, parent, t_token, target);
+	}
+	
+	if (!value || !json_copy_value(t_json, value, &copy))
+	{
+		JSON_LOG("operation has no value");
+		return 0;
+	}
+	if (json_patch_is("add"))
+	{
+		return json_patch_add(t_json, t_undo, parent, t_token, &copy);
+	}
+	if (json_patch_is("replace"))
+	{
+		if (!target)
+		{
+			JSON_LOG("nothing to replace");
+			return 0;
+		}
+		if (parent && parent->type == json_data_type_array)
+		{
+			unsigned int index = (unsigned int)(target - (const json_value*)parent->value.blob->array.buffer.data);
+			if (!json_patch_record(t_json, t_undo, json_patch_undo_set, parent, index))
+			{
+				return 0;
+			}
+			if (!json_array_set(t_json, parent, index, &copy))
+			{
+				--t_undo->element_count;
+				return 0;
+			}
+			return 1;
+		}
+		return json_patch_add(t_json, t_undo, parent, t_token, &copy);
+	}
+
+#undef json_patch_is
+	
+	JSON_LOG("op is not known");
+	return 0;
+}
+
+int json_patch(json_file* t_json, const json_value* t_patch)
+{
+	assert(t_json && t_patch);
+	
+	JSON_LOG("begin patch");
+	
+	if (t_patch->type != json_data_type_array)
+	{
+		JSON_LOG("patch is not an array");
+		return 0;
+	}
+	
+	/* the operations are applied in place, each edit recording how to reverse it, so a failed patch is undone and leaves the file as it was */
+	
+	vector token;
+	vector undo;
+	if (!vector_init(&token, sizeof(char)))
+	{
+		return 0;
+	}
+	if (!vector_init(&undo, sizeof(json_patch_undo)))
+	{
+		vector_final(&token);
+		return 0;
+	}
+	
+	const json_array* operations = &t_patch->value.blob->array;
+	int result = 1;
+	unsigned int i = 0;
+	for (; result && i < operations->element_count; ++i)
+	{
+		result = json_patch_operation(t_json, (const json_value*)operations->buffer.data + i, &token, &undo);
+	}
+	
+	if (!result)
+	{
+		json_patch_undo_edits(t_json, &undo);
+	}
+	
+	vector_final(&undo);
+	vector_final(&token);
+	
+	JSON_LOG(result ? "succeeded patch" : "failed patch operation");
+	
+	return result;
+}
+
+typedef struct
+{
+	json_file* json;
+	json_value operations;
+	vector pointer;
+} json_differ, *p_json_differ;
+
+int json_diff_push_key(p_json_differ t_differ, const char* t_key, size_t t_length)
+{
+	/* pointers escape ~ and / in names */
+	
+	const char* end = t_key + t_length;
+	
+	if (!vector_push(&t_differ->pointer, "/"))
+	{
+		return 0;
+	}
+	for (; t_key != end; ++t_key)
+	{
+		if ((*t_key == '~' && !vector_push_many(&t_differ->pointer, "~0", 2)) || (*t_key == '/' && !vector_push_many(&t_differ->pointer, "~1", 2)) || (*t_key != '~' && *t_key != '/' && !vector_push(&t_differ->pointer, t_key)))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int json_diff_push_index(p_json_differ t_differ, unsigned int t_index)
+{
+	char digits[16];
+	int length = snprintf(digits, sizeof(digits), "/%u", t_index);
+	
+	return vector_push_many(&t_differ->pointer, digits, (unsigned int)length);
+}
+
+int json_diff_emit(p_json_differ t_differ, const char* t_op, const json_value* t_value)
+{
+	json_value operation;
+	json_value op;
+	json_value path;
+	json_value value;
+	
+	return json_make_object(t_differ->json, &operation)
+		&& json_make_string(t_differ->json, t_op, strlen(t_op), &op)
+		&& json_make_string(t_differ->json, (const char*)t_differ->pointer.buffer.data, t_differ->pointer.element_count, &path)
+		&& json_object_set(t_differ->json, &operation, "op", 2, &op)
+		&& json_object_set(t_differ->json, &operation, "path", 4, &path)
+		&& (!t_value || (json_copy_value(t_differ->json, t_value, &value) && json_object_set(t_differ->json, &operation, "value", 5, &value)))
+		&& json_array_append(t_differ->json, &t_differ->operations, &operation);
+}
+
+int json_diff_value(p_json_differ t_differ, const json_value* t_from, const json_value* t_to)
+{
+	/* objects and arrays are compared member by member, anything else that differs is replaced whole */
+	
+	unsigned int length = t_differ->pointer.element_count;
+	
+	if (t_from->type == json_data_type_object && t_to->type == json_data_type_object)
+	{
+		const json_object* from = &t_from->value.blob->object;
+		const json_object* to = &t_to->value.blob->object;
+		
+		unsigned int i = 0;
+		for (; i < from->properties.element_count; ++i)
+		{
+			const json_property* property = (const json_property*)from->properties.buffer.data + i;
+			const json_property* other = json_object_lookup(to, property->key, 0, property->key_length, property->hash);
+			
+			if (!json_diff_push_key(t_differ, property->key, property->key_length) || !(other ? json_diff_value(t_differ, &property->value, &other->value) : json_diff_emit(t_differ, "remove", 0)))
+			{
+				return 0;
+			}
+			t_differ->pointer.element_count = length;
+		}
+		
+		for (i = 0; i < to->properties.element_count; ++i)
+		{
+			const json_property* property = (const json_property*)to->properties.buffer.data + i;
+			
+			if (!json_object_lookup(from, property->key, 0, property->key_length, property->hash) && (!json_diff_push_key(t_differ, property->key, property->key_length) || !json_diff_emit(t_differ, "add", &property->value)))
+			{
+				return 0;
+			}
+			t_differ->pointer.element_count = length;
+		}
+		return 1;
+	}
+	
+	if (t_from->type == json_data_type_array && t_to->type == json_data_type_array)
+	{
+		/* shared positions are compared in place, then the tail is removed from the end or appended */
+		
+		const json_array* from = &t_from->value.blob->array;
+		const json_array* to = &t_to->value.blob->array;
+		unsigned int shared = from->element_count < to->element_count ? from->element_count : to->element_count;
+		unsigned int i = 0;
+		
+		for (; i < shared; ++i)
+		{
+			if (!json_diff_push_index(t_differ, i) || !json_diff_value(t_differ, (const json_value*)from->buffer.data + i, (const json_value*)to->buffer.data + i))
+			{
+				return 0;
+			}
+			t_differ->pointer.element_count = length;
+		}
+		for (i = from->element_count; i > shared; --i)
+		{
+			if (!json_diff_push_index(t_differ, i - 1) || !json_diff_emit(t_differ, "remove", 0))
+			{
+				return 0;
+			}
+			t_differ->pointer.element_count = length;
+		}
+		for (i = shared; i < to->element_count; ++i)
+		{
+			if (!vector_push_many(&t_differ->pointer, "/-", 2) || !json_diff_emit(t_differ, "add", (const json_value*)to->buffer.data + i))
+			{
+				return 0;
+			}
+			t_differ->pointer.element_count = length;
+		}
+		return 1;
+	}
+	
+	return json_equals(t_from, t_to) || json_diff_emit(t_differ, "replace", t_to);
+}
+
+int json_diff(json_file* t_out_json, const json_file* t_from, const json_file* t_to, json_value* t_out_patch)
+{
+	assert(t_out_json && t_from && t_to && t_out_patch);
+	
+	JSON_LOG("begin diff");
+	
+	json_differ differ;
+	differ.json = t_out_json;
+	
+	if (!json_make_array(t_out_json, &differ.operations) || !vector_init(&differ.pointer, sizeof(char)))
+	{
+		return 0;
+	}
+	
+	json_value from = json_root((json_file*)t_from);
+	json_value to = json_root((json_file*)t_to);
+	int result = json_diff_value(&differ, &from, &to);
+	
+	vector_final(&differ.pointer);
+	
+	if (!result)
+	{
+		JSON_LOG("failed diff");
+		return 0;
+	}
+	
+	*t_out_patch = differ.operations;
+	return 1;
+}
+
+typedef struct
+{
+	const char* key;
+	size_t key_length;
+	unsigned int index;
+	int is_index;
+	int is_escaped;
+} json_path_segment, *p_json_path_segment;
+
+const char* json_path_read(const char* t_path, int t_is_first, p_json_path_segment t_out_segment)
+{
+	/* paths are property names joined by dots with array indices in brackets, as in a.b[3].c, a backslash takes the next character of a name as it is */
+	
+	assert(t_path && *t_path && t_out_segment);
+	
+	if (*t_path == '[')
+	{
+		const char* c = t_path + 1;
+		unsigned long long int index = 0;
+		
+		if (!is_digit(*c))
+		{
+			JSON_LOG("expected array index");
+			return 0;
+		}
+		for (; is_digit(*c); ++c)
+		{
+			index = index * 10 + (unsigned long long int)(*c - '0');
+			if (index > 0xffffffff)
+			{
+				JSON_LOG("array index too large");
+				return 0;
+			}
+		}
+		if (*c != ']')
+		{
+			JSON_LOG("expected closing bracket");
+			return 0;
+		}
+		
+		t_out_segment->key = 0;
+		t_out_segment->key_length = 0;
+		t_out_segment->index = (unsigned int)index;
+		t_out_segment->is_index = 1;
+		t_out_segment->is_escaped = 0;
+		return c + 1;
+	}
+	
+	if (!t_is_first)
+	{
+		if (*t_path != '.')
+		{
+			JSON_LOG("expected dot between path segments");
+			return 0;
+		}
+		++t_path;
+	}
+	
+	const char* c = t_path;
+	int is_escaped = 0;
+	while (*c && *c != '.' && *c != '[')
+	{
+		if (*c == '\\')
+		{
+			if (!c[1])
+			{
+				JSON_LOG("expected character after backslash");
+				return 0;
+			}
+			is_escaped = 1;
+			++c;
+		}
+		++c;
+	}
+	
+	t_out_segment->key = t_path;
+	t_out_segment->key_length = (size_t)(c - t_path);
+	t_out_segment->index = 0;
+	t_out_segment->is_index = 0;
+	t_out_segment->is_escaped = is_escaped;
+	return c;
+}
+
+size_t json_path_unescape(char* t_out, const char* t_key, size_t t_length)
+{
+	/* drops the backslashes of a name read by json_path_read, t_out may be t_key */
+	
+	const char* end = t_key + t_length;
+	char* out = t_out;
+	
+	for (; t_key != end; ++t_key)
+	{
+		if (*t_key == '\\')
+		{
+			++t_key;
+		}
+		*out++ = *t_key;
+	}
+	return (size_t)(out - t_out);
+}
+
+int json_key_equals(const char* t_c, const char* t_end, const char* t_key, size_t t_length)
+{
+	/* compares a property name as written in the text with a key, decoding escapes only when there are any */
+	
+	if ((size_t)(t_end - t_c) == t_length && !memcmp(t_c, t_key, t_length))
+	{
+		return 1;
+	}
+	if (!memchr(t_c, '\\', (size_t)(t_end - t_c)))
+	{
+		return 0;
+	}
+	
+	const char* key_end = t_key + t_length;
+	while (t_c != t_end)
+	{
+		char decoded[4];
+		unsigned int length = 1;
+		
+		if (*t_c == '\\')
+		{
+			++t_c;
+			length = json_decode_escape(&t_c, t_end, decoded);
+		}
+		else
+		{
+			decoded[0] = *t_c++;
+		}
+		if (!length || (size_t)(key_end - t_key) < length || memcmp(decoded, t_key, length))
+		{
+			return 0;
+		}
+		t_key += length;
+	}
+	return t_key == key_end;
+}
+
+int json_document_load_from_buffer(json_document* t_document, const char* t_data, size_t t_size)
+{
+	assert(t_document && (t_data || !t_size));
+	
+	JSON_LOG("begin load document from buffer");
+	
+	memset(t_document, 0, sizeof(json_document));
+	
+	if (!json_scan(t_data, t_size, &t_document->structurals))
+	{
+		JSON_LOG("failed to scan structure");
+		return 0;
+	}
+	
+	unsigned int count = t_document->structurals.element_count;
+	const unsigned int* structurals = (const unsigned int*)t_document->structurals.buffer.data;
+	
+	if (!vector_init(&t_document->closes, sizeof(unsigned int)) || !vector_resize(&t_document->closes, count + 1)
+		|| !vector_init(&t_document->values, sizeof(json_value)) || !vector_init(&t_document->frames, sizeof(json_frame))
+		|| !arena_init(&t_document->json.arena, JSON_ARENA_CHUNK_SIZE))
+	{
+		JSON_LOG("failed to initialize document");
+		goto json_document_load_from_buffer_fail;
+	}
+	
+	/* each open bracket records the index of its close, so whole containers are stepped over at once */
+	
+	unsigned int* closes = (unsigned int*)t_document->closes.buffer.data;
+	vector opens;
+	if (!vector_init(&opens, sizeof(unsigned int)))
+	{
+		goto json_document_load_from_buffer_fail;
+	}
+	
+	unsigned int i = 0;
+	for (; i < count; ++i)
+	{
+		char c = t_data[structurals[i]];
+		closes[i] = 0;
+		
+		if (c == '{' || c == '[')
+		{
+			if (!vector_push(&opens, &i))
+			{
+				break;
+			}
+		}
+		else if (c == '}' || c == ']')
+		{
+			unsigned int open = opens.element_count ? ((unsigned int*)opens.buffer.data)[--opens.element_count] : count;
+			if (open == count || t_data[structurals[open]] != (c == '}' ? '{' : '['))
+			{
+				break;
+			}
+			closes[open] = i;
+		}
+	}
+	
+	int is_balanced = i == count && !opens.element_count && count && (closes[0] == count - 1 || (count <= 2 && t_data[structurals[0]] != '{' && t_data[structurals[0]] != '['));
+	vector_final(&opens);
+	
+	if (!is_balanced)
+	{
+		JSON_LOG("brackets are unbalanced");
+		goto json_document_load_from_buffer_fail;
+	}
+	t_document->closes.element_count = count;
+	
+	t_document->json.source.data = t_data;
+	t_document->json.source.size = t_size;
+	
+	JSON_LOG("succeeded load document from buffer");
+	
+	return 1;
+	
+json_document_load_from_buffer_fail:
+	
+	json_document_final(t_document);
+	return 0;
+}
+
+int json_document_load(json_document* t_document, const char* t_path)
+{
+	assert(t_document && t_path);
+	
+	JSON_LOG("begin load document");
+	
+	json_mapping mapping;
+	if (!json_mapping_init(&mapping, t_path))
+	{
+		JSON_LOG("failed to map file");
+		return 0;
+	}
+	
+	if (!json_document_load_from_buffer(t_document, mapping.data, mapping.size))
+	{
+		json_mapping_final(&mapping);
+		return 0;
+	}
+	
+	t_document->json.source = mapping;
+	
+	JSON_LOG("succeeded load document");
+	
+	return 1;
+}
+
+void json_document_final(json_document* t_document)
+{
+	assert(t_document);
+	
+	vector_final(&t_document->frames);
+	vector_final(&t_document->values);
+	vector_final(&t_document->closes);
+	vector_final(&t_document->structurals);
+	json_final(&t_document->json);
+}
+
+int json_document_reset(json_document* t_document)
+{
+	assert(t_document);
+	
+	/* the structural index stays, only what json_get decoded is released */
+	
+	arena_final(&t_document->json.arena);
+	if (!arena_init(&t_document->json.arena, JSON_ARENA_CHUNK_SIZE))
+	{
+		JSON_LOG("failed to initialize document arena");
+		return 0;
+	}
+	return 1;
+}
+
+unsigned int json_document_skip(const json_document* t_document, unsigned int t_structural)
+{
+	/* the index of the structural after the value starting at t_structural */
+	
+	const char c = t_document->json.source.data[((const unsigned int*)t_document->structurals.buffer.data)[t_structural]];
+	
+	if (c == '{' || c == '[')
+	{
+		return ((const unsigned int*)t_document->closes.buffer.data)[t_structural] + 1;
+	}
+	return c == '"' ? t_structural + 2 : t_structural + 1;
+}
+
+int json_document_find(const json_document* t_document, const char* t_path, unsigned int* t_out_structural)
+{
+	assert(t_document && t_path && t_out_structural);
+	
+	const char* data = t_document->json.source.data;
+	const unsigned int* structurals = (const unsigned int*)t_document->structurals.buffer.data;
+	const unsigned int* closes = (const unsigned int*)t_document->closes.buffer.data;
+	unsigned int i = 0;
+	int is_first = 1;
+	
+	while (*t_path)
+	{
+		json_path_segment segment;
+		
+		t_path = json_path_read(t_path, is_first, &segment);
+		if (!t_path)
+		{
+			return 0;
+		}
+		is_first = 0;
+		
+		char c = data[structurals[i]];
+		if (c != (segment.is_index ? '[' : '{'))
+		{
+			JSON_LOG("path does not match the document");
+			return 0;
+		}
+		
+		/* escaped names are compared without their backslashes, unescaped on the stack unless they are long */
+		
+		char name[JSON_PATH_NAME_SIZE];
+		char* allocated = 0;
+		if (segment.is_escaped)
+		{
+			char* unescaped = name;
+			if (segment.key_length > sizeof(name) && !(unescaped = allocated = (char*)malloc(segment.key_length)))
+			{
+				JSON_LOG("failed to allocate path name");
+				return 0;
+			}
+			segment.key_length = json_path_unescape(unescaped, segment.key, segment.key_length);
+			segment.key = unescaped;
+		}
+		
+		/* step over every entry before the one wanted without decoding it */
+		
+		unsigned int end = closes[i];
+		unsigned int j = i + 1;
+		unsigned int index = 0;
+		
+		for (;; ++index)
+		{
+			unsigned int value = segment.is_index ? j : j + 3;
+			
+			if (value >= end || (!segment.is_index && (data[structurals[j]] != '"' || data[structurals[j + 2]] != ':')))
+			{
+				free(allocated);
+				return 0;
+			}
+			if (segment.is_index ? index == segment.index : json_key_equals(data + structurals[j] + 1, data + structurals[j + 1], segment.key, segment.key_length))
+			{
+				i = value;
+				break;
+			}
+			
+			j = json_document_skip(t_document, value);
+			if (j >= end || data[structurals[j]] != ',')
+			{
+				free(allocated);
+				return 0;
+			}
+			++j;
+		}
+		free(allocated);
+	}
+	
+	*t_out_structural = i;
+	return 1;
+}
+
+int json_get(json_document* t_document, const char* t_path, json_value* t_out_value)
+{
+	assert(t_document && t_path && t_out_value);
+	
+	unsigned int structural = 0;
+	if (!json_document_find(t_document, t_path, &structural))
+	{
+		JSON_LOG("failed to find \"%s\"", t_path);
+		return 0;
+	}
+	
+	/* only the value found is decoded */
+	
+	json_cursor cursor;
+	const unsigned int* structurals = (const unsigned int*)t_document->structurals.buffer.data;
+	
+	cursor.data = t_document->json.source.data;
+	cursor.end = cursor.data + t_document->json.source.size;
+	cursor.structural = structurals + structural;
+	cursor.structural_end = structurals + json_document_skip(t_document, structural);
+	cursor.prebuilt = 0;
+	cursor.values = t_document->values;
+	cursor.frames = t_document->frames;
+	cursor.max_depth = JSON_MAX_DEPTH;
+	cursor.exact_integers = 0;
+	cursor.validate_utf8 = 0;
+	
+	int result = json_read_value(&cursor, &t_document->json, t_out_value) && cursor.structural == cursor.structural_end;
+	
+	/* the stacks may have grown, keep them for the next call */
+	
+	cursor.values.element_count = 0;
+	cursor.frames.element_count = 0;
+	t_document->values = cursor.values;
+	t_document->frames = cursor.frames;
+	
+	if (!result)
+	{
+		JSON_LOG("failed to decode \"%s\"", t_path);
+		*t_out_value = json_undefined;
+		return 0;
+	}
+	return 1;
+}
+
+int json_path_compile(json_compiled_path* t_path, const char* t_string)
+{
+	assert(t_path && t_string);
+	
+	JSON_LOG("begin compile path \"%s\"", t_string);
+	
+	/* the keys are copied into one block, hashed once, and used for every resolve */
+	
+	size_t length = strlen(t_string);
+	t_path->keys = (char*)malloc(length + 1);
+	if (!t_path->keys || !vector_init(&t_path->steps, sizeof(json_path_step)))
+	{
+		JSON_LOG("failed to allocate path");
+		free(t_path->keys);
+		t_path->keys = 0;
+		return 0;
+	}
+	memcpy(t_path->keys, t_string, length + 1);
+	
+	const char* c = t_path->keys;
+	int is_first = 1;
+	while (*c)
+	{
+		json_path_segment segment;
+		json_path_step step;
+		
+		c = json_path_read(c, is_first, &segment);
+		if (!c)
+		{
+			json_path_final(t_path);
+			return 0;
+		}
+		is_first = 0;
+		
+		/* escaped names lose their backslashes in the path's own copy */
+		
+		step.key = segment.key;
+		step.key_length = segment.is_escaped ? json_path_unescape((char*)segment.key, segment.key, segment.key_length) : segment.key_length;
+		step.index = segment.index;
+		step.hash = segment.is_index ? 0 : json_key_hash(step.key, step.key_length);
+		step.is_index = segment.is_index;
+		step.interned = 0;
+		
+		if (!vector_push(&t_path->steps, &step))
+		{
+			JSON_LOG("failed to push path step");
+			json_path_final(t_path);
+			return 0;
+		}
+	}
+	
+	JSON_LOG("succeeded compile path");
+	
+	return 1;
+}
+
+void json_path_final(json_compiled_path* t_path)
+{
+	assert(t_path);
+	
+	vector_final(&t_path->steps);
+	free(t_path->keys);
+	t_path->keys = 0;
+}
+
+int json_path_bind(json_compiled_path* t_path, const json_file* t_json)
+{
+	assert(t_path && t_json);
+	
+	/* names the file does not hold, or every name when its keys are not interned, are compared by characters as before */
+	
+	json_path_step* step = (json_path_step*)t_path->steps.buffer.data;
+	json_path_step* end = step + t_path->steps.element_count;
+	unsigned int bound = 0;
+	
+	for (; step != end; ++step)
+	{
+		step->interned = step->is_index ? 0 : json_intern_find(t_json, step->key, step->key_length);
+		bound += step->interned != 0;
+	}
+	
+	JSON_LOG("bound %u of %u path steps", bound, t_path->steps.element_count);
+	
+	return 1;
+}
+
+int json_path_resolve(const json_compiled_path* t_path, const json_value* t_root, json_value** t_out_value)
+{
+	assert(t_path && t_root && t_out_value);
+	
+	const json_path_step* step = (const json_path_step*)t_path->steps.buffer.data;
+	const json_path_step* end = step + t_path->steps.element_count;
+	const json_value* value = t_root;
+	
+	for (; step != end; ++step)
+	{
+		if (step->is_index)
+		{
+			if (value->type != json_data_type_array || step->index >= value->value.blob->array.element_count)
+			{
+				return 0;
+			}
+			value = (const json_value*)value->value.blob->array.buffer.data + step->index;
+		}
+		else
+		{
+			if (value->type != json_data_type_object)
+			{
+				return 0;
+			}
+			
+			const json_property* property = step->key_length <= (unsigned int)-1 ? json_object_lookup(&value->value.blob->object, step->key, step->interned, (unsigned int)step->key_length, step->hash) : 0;
+			if (!property)
+			{
+				return 0;
+			}
+			value = &property->value;
+		}
+	}
+	
+	*t_out_value = (json_value*)value;
+	return 1;
+}
+
+int json_path_resolve_file(const json_compiled_path* t_path, const json_file* t_json, json_value** t_out_value)
+{
+	assert(t_path && t_json && t_out_value);
+	
+	if (!t_path->steps.element_count)
+	{
+		JSON_LOG("the root of a json file is not a value");
+		return 0;
+	}
+	
+	json_value root;
+	root.type = json_data_type_object;
+	root.value.blob = (p_json_blob)&t_json->root;
+	
+	return json_path_resolve(t_path, &root, t_out_value);
+}
+
+typedef struct
+{
+	const char* data;
+	size_t size;
+	json_file json;
+	vector roots;
+	int result;
+} json_lines_part;
+
+typedef struct
+{
+	json_lines_part* parts;
+	unsigned int part_count;
+	const json_load_options* options;
+	atomic next_part;
+} json_lines_work;
+
+int json_lines_read_part(json_lines_part* t_part, const json_load_options* t_options)
+{
+	assert(t_part);
+	
+	/* the part is indexed once and then each line reads from its own slice of the index */
+	
+	vector structurals;
+	if (!json_scan(t_part->data, t_part->size, &structurals))
+	{
+		JSON_LOG("failed to scan structure");
+		return 0;
+	}
+	
+	json_cursor cursor;
+	if (!vector_init(&cursor.values, sizeof(json_value)))
+	{
+		JSON_LOG("failed to init value stack");
+		vector_final(&structurals);
+		return 0;
+	}
+	if (!vector_init(&cursor.frames, sizeof(json_frame)))
+	{
+		JSON_LOG("failed to init frame stack");
+		vector_final(&cursor.values);
+		vector_final(&structurals);
+		return 0;
+	}
+	cursor.data = t_part->data;
+	cursor.prebuilt = 0;
+	cursor.max_depth = t_options->max_depth;
+	cursor.exact_integers = t_options->exact_integers;
+	cursor.validate_utf8 = t_options->validate_utf8;
+	
+	const unsigned int* structural = (const unsigned int*)structurals.buffer.data;
+	const unsigned int* structural_end = structural + structurals.element_count;
+	const char* line = t_part->data;
+	const char* end = t_part->data + t_part->size;
+	int result = 1;
+	
+	while (result && line != end)
+	{
+		const char* line_end = (const char*)memchr(line, '\n', (size_t)(end - line));
+		line_end = line_end ? line_end : end;
+		
+		unsigned int line_end_offset = (unsigned int)(line_end - t_part->data);
+		cursor.structural = structural;
+		while (structural != structural_end && *structural < line_end_offset)
+		{
+			++structural;
+		}
+		cursor.structural_end = structural;
+		cursor.end = line_end;
+		
+		/* blank lines hold no record */
+		
+		if (cursor.structural != cursor.structural_end)
+		{
+			json_value root;
+			result = json_read_value(&cursor, &t_part->json, &root) && cursor.structural == cursor.structural_end && vector_push(&t_part->roots, &root);
+		}
+		
+		line = line_end == end ? end : line_end + 1;
+	}
+	
+	vector_final(&cursor.frames);
+	vector_final(&cursor.values);
+	vector_final(&structurals);
+	
+	if (!result)
+	{
+		JSON_LOG("failed to read line %u", t_part->roots.element_count);
+	}
+	return result;
+}
+
+void json_lines_worker(void* t_work)
+{
+	json_lines_work* work = (json_lines_work*)t_work;
+	unsigned long long int index;
+	
+	while ((index = atomic_increment(&work->next_part)) < work->part_count)
+	{
+		json_lines_part* part = &work->parts[index];
+		part->result = json_lines_read_part(part, work->options);
+	}
+}
+
+int json_load_lines_from_buffer_with_options(json_lines* t_lines, const char* t_data, size_t t_size, const json_load_options* t_options)
+{
+	assert(t_lines && (t_data || !t_size) && t_options);
+	
+	JSON_LOG("begin load lines from buffer");
+	
+	unsigned int thread_count = t_options->thread_count ? t_options->thread_count : thread_count_cores();
+	
+	/* parts end on line boundaries, there are at least as many as threads so each is small enough to index */
+	
+	size_t part_size = t_size / thread_count + 1;
+	part_size = part_size < JSON_LINES_MIN_PART_SIZE ? JSON_LINES_MIN_PART_SIZE : part_size;
+	part_size = part_size > JSON_LINES_MAX_PART_SIZE ? JSON_LINES_MAX_PART_SIZE : part_size;
+	
+	json_lines_work work;
+	work.parts = (json_lines_part*)malloc((size_t)(t_size / part_size + 1) * sizeof(json_lines_part));
+	work.part_count = 0;
+	work.options = t_options;
+	atomic_init(&work.next_part, 0);
+	
+	if (!work.parts)
+	{
+		JSON_LOG("failed to allocate parts");
+		return 0;
+	}
+	
+	int result = 1;
+	const char* start = t_data;
+	const char* end = t_data + t_size;
+	while (start != end)
+	{
+		const char* cut = (size_t)(end - start) > part_size ? start + part_size : end;
+		cut = (const char*)memchr(cut - 1, '\n', (size_t)(end - cut + 1));
+		cut = cut ? cut + 1 : end;
+		
+		json_lines_part* part = &work.parts[work.part_count];
+		part->data = start;
+		part->size = (size_t)(cut - start);
+		part->result = 0;
+		memset(&part->json.keys, 0, sizeof(part->json.keys));
+		memset(&part->json.spans, 0, sizeof(part->json.spans));
+		if (!arena_init(&part->json.arena, JSON_ARENA_CHUNK_SIZE))
+		{
+			result = 0;
+			break;
+		}
+		if (!vector_init(&part->roots, sizeof(json_value)))
+		{
+			arena_final(&part->json.arena);
+			result = 0;
+			break;
+		}
+		++work.part_count;
+		start = cut;
+	}
+	
+	if (result)
+	{
+		/* find the classifier before the workers race to */
+		
+		json_find_classify();
+		
+		thread_count = thread_count < work.part_count ? thread_count : work.part_count;
+		thread* threads = thread_count > 1 ? (thread*)malloc((thread_count - 1) * sizeof(thread)) : 0;
+		unsigned int started = 0;
+		
+		for (; threads && started < thread_count - 1; ++started)
+		{
+			if (!thread_init(&threads[started], json_lines_worker, &work))
+			{
+				JSON_LOG("failed to start thread, continuing with fewer");
+				break;
+			}
+		}
+		
+		json_lines_worker(&work);
+		
+		unsigned int i = 0;
+		for (; i < started; ++i)
+		{
+			thread_join(&threads[i]);
+			thread_final(&threads[i]);
+		}
+		free(threads);
+	}
+	
+	/* gather the roots in line order, the part arenas move to the lines */
+	
+	unsigned int root_count = 0;
+	unsigned int i = 0;
+	for (; i < work.part_count; ++i)
+	{
+		result = result && work.parts[i].result;
+		root_count += work.parts[i].roots.element_count;
+	}
+	
+	if (result && (!vector_init(&t_lines->roots, sizeof(json_value)) || !vector_resize(&t_lines->roots, root_count ? root_count : 1)))
+	{
+		JSON_LOG("failed to allocate roots");
+		vector_final(&t_lines->roots);
+		result = 0;
+	}
+	if (result && (!vector_init(&t_lines->arenas, sizeof(arena)) || !vector_resize(&t_lines->arenas, work.part_count ? work.part_count : 1)))
+	{
+		JSON_LOG("failed to allocate arenas");
+		vector_final(&t_lines->arenas);
+		vector_final(&t_lines->roots);
+		result = 0;
+	}
+	
+	for (i = 0; i < work.part_count; ++i)
+	{
+		json_lines_part* part = &work.parts[i];
+		if (result)
+		{
+			vector_push_many(&t_lines->roots, part->roots.buffer.data, part->roots.element_count);
+			vector_push(&t_lines->arenas, &part->json.arena);
+		}
+		else
+		{
+			arena_final(&part->json.arena);
+		}
+		vector_final(&part->roots);
+	}
+	free(work.parts);
+	atomic_final(&work.next_part);
+	
+	if (!result)
+	{
+		JSON_LOG("failed load lines from buffer");
+		return 0;
+	}
+	
+	t_lines->source.data = t_data;
+	t_lines->source.size = t_size;
+	t_lines->source.is_mapped = 0;
+	t_lines->source.is_allocated = 0;
+	
+	JSON_LOG("succeeded load lines from buffer, %u records", t_lines->roots.element_count);
+	
+	return 1;
+}
+
+int json_load_lines_from_buffer(json_lines* t_lines, const char* t_data, size_t t_size)
+{
+	json_load_options options;
+	json_load_options_init(&options);
+	
+	return json_load_lines_from_buffer_with_options(t_lines, t_data, t_size, &options);
+}
+
+int json_load_lines_with_options(json_lines* t_lines, const char* t_path, const json_load_options* t_options)
+{
+	assert(t_lines && t_path && t_options);
+	
+	JSON_LOG("begin load lines");
+	
+	json_mapping mapping;
+	if (!json_mapping_init(&mapping, t_path))
+	{
+		JSON_LOG("failed to map file");
+		return 0;
+	}
+	
+	if (!json_load_lines_from_buffer_with_options(t_lines, mapping.data, mapping.size, t_options))
+	{
+		json_mapping_final(&mapping);
+		return 0;
+	}
+	
+	t_lines->source = mapping;
+	
+	JSON_LOG("succeeded load lines");
+	
+	return 1;
+}
+
+int json_load_lines(json_lines* t_lines, const char* t_path)
+{
+	json_load_options options;
+	json_load_options_init(&options);
+	
+	return json_load_lines_with_options(t_lines, t_path, &options);
+}
+
+void json_lines_final(json_lines* t_lines)
+{
+	assert(t_lines);
+	
+	unsigned int i = 0;
+	for (; i < t_lines->arenas.element_count; ++i)
+	{
+		arena_final((p_arena)vector_get_index(&t_lines->arenas, i));
+	}
+	vector_final(&t_lines->arenas);
+	vector_final(&t_lines->roots);
+	json_mapping_final(&t_lines->source);
+}
+
+#define json_reader_state_value 0
+#define json_reader_state_first_value 1
+#define json_reader_state_key 2
+#define json_reader_state_first_key 3
+#define json_reader_state_colon 4
+#define json_reader_state_after_value 5
+#define json_reader_state_string 6
+#define json_reader_state_escape 7
+#define json_reader_state_number 8
+#define json_reader_state_literal 9
+#define json_reader_state_error 10
+
+int json_reader_init(json_reader* t_reader, const json_reader_callbacks* t_callbacks, void* t_context)
+{
+	assert(t_reader && t_callbacks);
+	
+	if (!vector_init(&t_reader->token, sizeof(char)))
+	{
+		JSON_LOG("failed to init token");
+		return 0;
+	}
+	if (!vector_init(&t_reader->containers, sizeof(char)))
+	{
+		JSON_LOG("failed to init container stack");
+		vector_final(&t_reader->token);
+		return 0;
+	}
+	
+	t_reader->callbacks = *t_callbacks;
+	t_reader->context = t_context;
+	t_reader->string.data = 0;
+	t_reader->string.size = 0;
+	t_reader->max_depth = JSON_MAX_DEPTH;
+	t_reader->validate_utf8 = 0;
+	t_reader->state = json_reader_state_value;
+	t_reader->is_key = 0;
+	t_reader->offset = 0;
+	
+	return 1;
+}
+
+void json_reader_final(json_reader* t_reader)
+{
+	assert(t_reader);
+	
+	vector_final(&t_reader->containers);
+	vector_final(&t_reader->token);
+}
+
+int json_reader_end_value(p_json_reader t_reader)
+{
+	t_reader->state = t_reader->containers.element_count ? json_reader_state_after_value : json_reader_state_value;
+	return 1;
+}
+
+int json_reader_emit(p_json_reader t_reader, const json_value* t_value)
+{
+	if (t_reader->callbacks.value && !t_reader->callbacks.value(t_reader->context, t_value))
+	{
+		JSON_LOG("value callback stopped reader");
+		return 0;
+	}
+	return json_reader_end_value(t_reader);
+}
+
+int json_reader_end_string(p_json_reader t_reader)
+{
+	char* start = (char*)t_reader->token.buffer.data;
+	char* end = start + t_reader->token.element_count;
+	
+	if (t_reader->validate_utf8 && !json_validate_utf8(start, end))
+	{
+		JSON_LOG("string is not valid utf-8");
+		return 0;
+	}
+	
+	const char* escape = (const char*)memchr(start, '\\', t_reader->token.element_count);
+	
+	if (escape && !(end = json_decode_string(start, end, escape, start)))
+	{
+		return 0;
+	}
+	
+	t_reader->string.data = start;
+	t_reader->string.size = (size_t)(end - start);
+	
+	if (t_reader->is_key)
+	{
+		if (t_reader->callbacks.key && !t_reader->callbacks.key(t_reader->context, &t_reader->string))
+		{
+			JSON_LOG("key callback stopped reader");
+			return 0;
+		}
+		t_reader->state = json_reader_state_colon;
+		return 1;
+	}
+	
+	json_value value;
+	value.type = json_data_type_string;
+	value.value.blob = (p_json_blob)&t_reader->string;
+	
+	return json_reader_emit(t_reader, &value);
+}
+
+int json_reader_end_token(p_json_reader t_reader)
+{
+	const char* token = (const char*)t_reader->token.buffer.data;
+	size_t length = t_reader->token.element_count;
+	json_value value = json_undefined;
+	
+	if (t_reader->state == json_reader_state_number)
+	{
+		if (json_parse_number(token, token + length, 0, &value) != token + length)
+		{
+			JSON_LOG("failed to read number");
+			return 0;
+		}
+	}
+	else if (length == 4 && !memcmp(token, "true", 4))
+	{
+		value.type = json_data_type_boolean;
+		value.value.boolean = 1;
+	}
+	else if (length == 5 && !memcmp(token, "false", 5))
+	{
+		value.type = json_data_type_boolean;
+		value.value.boolean = 0;
+	}
+	else if (length == 4 && !memcmp(token, "null", 4))
+	{
+		value.type = json_data_type_null;
+		value.value.null = 0;
+	}
+	else
+	{
+		JSON_LOG("unknown literal, expected true, false or null");
+		return 0;
+	}
+	
+	return json_reader_emit(t_reader, &value);
+}
+
+int json_reader_open(p_json_reader t_reader, char t_c)
+{
+	if (t_reader->containers.element_count >= t_reader->max_depth)
+	{
+		JSON_LOG("maximum depth exceeded");
+		return 0;
+	}
+	if (!vector_push(&t_reader->containers, &t_c))
+	{
+		JSON_LOG("failed to push container");
+		return 0;
+	}
+	
+	int (*callback)(void*) = t_c == '{' ? t_reader->callbacks.start_object : t_reader->callbacks.start_array;
+	if (callback && !callback(t_reader->context))
+	{
+		JSON_LOG("start callback stopped reader");
+		return 0;
+	}
+	
+	t_reader->state = t_c == '{' ? json_reader_state_first_key : json_reader_state_first_value;
+	return 1;
+}
+
+int json_reader_close(p_json_reader t_reader, char t_c)
+{
+	char open = *(char*)vector_get_index(&t_reader->containers, t_reader->containers.element_count - 1);
+	if (t_c != (open == '{' ? '}' : ']'))
+	{
+		JSON_LOG("character is unexpected, fail out");
+		return 0;
+	}
+	--t_reader->containers.element_count;
+	
+	int (*callback)(void*) = open == '{' ? t_reader->callbacks.end_object : t_reader->callbacks.end_array;
+	if (callback && !callback(t_reader->context))
+	{
+		JSON_LOG("end callback stopped reader");
+		return 0;
+	}
+	
+	return json_reader_end_value(t_reader);
+}
+
+int json_reader_begin_value(p_json_reader t_reader, char t_c)
+{
+	if (t_c == '{' || t_c == '[')
+	{
+		return json_reader_open(t_reader, t_c);
+	}
+	
+	t_reader->token.element_count = 0;
+	
+	if (t_c == '"')
+	{
+		t_reader->is_key = 0;
+		t_reader->state = json_reader_state_string;
+		return 1;
+	}
+	if (t_c == '-' || is_digit(t_c))
+	{
+		t_reader->state = json_reader_state_number;
+		return vector_push(&t_reader->token, &t_c);
+	}
+	if (t_c == 't' || t_c == 'f' || t_c == 'n')
+	{
+		t_reader->state = json_reader_state_literal;
+		return vector_push(&t_reader->token, &t_c);
+	}
+	
+	JSON_LOG("value is unexpected, fail out");
+	return 0;
+}
+
+int json_reader_structural(p_json_reader t_reader, char t_c)
+{
+	switch (t_reader->state)
+	{
+	case json_reader_state_first_value:
+		if (t_c == ']')
+		{
+			return json_reader_close(t_reader, t_c);
+		}
+		return json_reader_begin_value(t_reader, t_c);
+	case json_reader_state_value:
+		return json_reader_begin_value(t_reader, t_c);
+	case json_reader_state_first_key:
+		if (t_c == '}')
+		{
+			return json_reader_close(t_reader, t_c);
+		}
+		/* fall through */
+	case json_reader_state_key:
+		if (t_c != '"')
+		{
+			JSON_LOG("failed to read property name");
+			return 0;
+		}
+		t_reader->token.element_count = 0;
+		t_reader->is_key = 1;
+		t_reader->state = json_reader_state_string;
+		return 1;
+	case json_reader_state_colon:
+		if (t_c != ':')
+		{
+			JSON_LOG("failed to read colon");
+			return 0;
+		}
+		t_reader->state = json_reader_state_value;
+		return 1;
+	case json_reader_state_after_value:
+		if (t_c == ',')
+		{
+			char open = *(char*)vector_get_index(&t_reader->containers, t_reader->containers.element_count - 1);
+			t_reader->state = open == '{' ? json_reader_state_key : json_reader_state_value;
+			return 1;
+		}
+		return json_reader_close(t_reader, t_c);
+	default:
+		return 0;
+	}
+}
+
+int json_reader_is_token_character(unsigned int t_state, char t_c)
+{
+	if (t_state == json_reader_state_number)
+	{
+		return is_digit(t_c) || t_c == '-' || t_c == '+' || t_c == '.' || t_c == 'e' || t_c == 'E';
+	}
+	return t_c >= 'a' && t_c <= 'z';
+}
+
+int json_reader_feed(json_reader* t_reader, const char* t_data, size_t t_size)
+{
+	assert(t_reader && (t_data || !t_size));
+	
+	if (t_reader->state == json_reader_state_error)
+	{
+		return 0;
+	}
+	
+	const char* c = t_data;
+	const char* end = t_data + t_size;
+	
+	while (c != end)
+	{
+		switch (t_reader->state)
+		{
+		case json_reader_state_string:
+		{
+			/* copy up to the next quote or escape in one go, the string may continue in the next chunk */
+			
+			const char* run = c;
+			while (c != end && *c != '"' && *c != '\\')
+			{
+				++c;
+			}
+			if (!vector_push_many(&t_reader->token, run, (unsigned int)(c - run)))
+			{
+				goto json_reader_feed_fail;
+			}
+			if (c == end)
+			{
+				break;
+			}
+			if (*c++ == '\\')
+			{
+				/* escapes are kept as written and decoded once the string ends */
+				
+				if (!vector_push(&t_reader->token, c - 1))
+				{
+					goto json_reader_feed_fail;
+				}
+				t_reader->state = json_reader_state_escape;
+			}
+			else if (!json_reader_end_string(t_reader))
+			{
+				goto json_reader_feed_fail;
+			}
+			break;
+		}
+		case json_reader_state_escape:
+		{
+			if (!vector_push(&t_reader->token, c++))
+			{
+				goto json_reader_feed_fail;
+			}
+			t_reader->state = json_reader_state_string;
+			break;
+		}
+		case json_reader_state_number:
+		case json_reader_state_literal:
+		{
+			const char* run = c;
+			while (c != end && json_reader_is_token_character(t_reader->state, *c))
+			{
+				++c;
+			}
+			if (!vector_push_many(&t_reader->token, run, (unsigned int)(c - run)))
+			{
+				goto json_reader_feed_fail;
+			}
+			
+			/* the character that ended the token is left for the next state */
+			
+			if (c != end && !json_reader_end_token(t_reader))
+			{
+				goto json_reader_feed_fail;
+			}
+			break;
+		}
+		default:
+		{
+			if (!is_whitespace(*c) && !json_reader_structural(t_reader, *c))
+			{
+				goto json_reader_feed_fail;
+			}
+			++c;
+			break;
+		}
+		}
+	}
+	
+	t_reader->offset += t_size;
+	return 1;
+	
+json_reader_feed_fail:
+	
+	t_reader->offset += (size_t)(c - t_data);
+	t_reader->state = json_reader_state_error;
+	return 0;
+}
+
+int json_reader_finish(json_reader* t_reader)
+{
+	assert(t_reader);
+	
+	if ((t_reader->state == json_reader_state_number || t_reader->state == json_reader_state_literal) && !json_reader_end_token(t_reader))
+	{
+		t_reader->state = json_reader_state_error;
+		return 0;
+	}
+	if (t_reader->state != json_reader_state_value || t_reader->containers.element_count)
+	{
+		JSON_LOG("unexpected end of json");
+		t_reader->state = json_reader_state_error;
+		return 0;
+	}
+	return 1;
+}
+
+int json_read_file(const char* t_path, const json_reader_callbacks* t_callbacks, void* t_context)
+{
+	assert(t_path && t_callbacks);
+	
+	JSON_LOG("begin read file");
+	
+	FILE* file = fopen(t_path, "rb");
+	if (!file)
+	{
+		JSON_LOG("failed to open file");
+		return 0;
+	}
+	
+	char* chunk = (char*)malloc(JSON_READER_CHUNK_SIZE);
+	json_reader reader;
+	if (!chunk || !json_reader_init(&reader, t_callbacks, t_context))
+	{
+		JSON_LOG("failed to init reader");
+		free(chunk);
+		fclose(file);
+		return 0;
+	}
+	
+	int result = 1;
+	size_t size;
+	while (result && (size = fread(chunk, 1, JSON_READER_CHUNK_SIZE, file)) > 0)
+	{
+		result = json_reader_feed(&reader, chunk, size);
+	}
+	result = result && !ferror(file) && json_reader_finish(&reader);
+	
+	json_reader_final(&reader);
+	free(chunk);
+	fclose(file);
+	
+	JSON_LOG(result ? "succeeded read file" : "failed to read file");
+	
+	return result;
+}
+
+int json_parser_copy_string(p_json_parser t_parser, const json_string* t_string, json_string* t_out_string)
+{
+	/* the reader reuses its token, so strings are copied into the arena */
+	
+	char* copy = (char*)arena_alloc(&t_parser->json->arena, t_string->size + 1);
+	if (!copy)
+	{
+		JSON_LOG("failed to allocate string");
+		return 0;
+	}
+	memcpy(copy, t_string->data, t_string->size);
+	copy[t_string->size] = '\0';
+	
+	t_out_string->data = copy;
+	t_out_string->size = t_string->size;
+	return 1;
+}
+
+p_json_frame json_parser_top(p_json_parser t_parser)
+{
+	return t_parser->frames.element_count ? (p_json_frame)vector_get_index(&t_parser->frames, t_parser->frames.element_count - 1) : 0;
+}
+
+int json_parser_emit(p_json_parser t_parser, const json_value* t_value)
+{
+	p_json_frame frame = json_parser_top(t_parser);
+	
+	if (!frame && t_parser->root.type != json_data_type_undefined)
+	{
+		JSON_LOG("unexpected value after root");
+		return 0;
+	}
+	return json_emit_value(&t_parser->values, frame, t_value, &t_parser->root);
+}
+
+int json_parser_open(p_json_parser t_parser, char t_c)
+{
+	json_frame opened;
+	opened.key = 0;
+	
+	if (!json_alloc_container(t_parser->json, t_c, &opened.value) || !json_parser_emit(t_parser, &opened.value))
+	{
+		return 0;
+	}
+	
+	opened.first_value = t_parser->values.element_count;
+	return vector_push(&t_parser->frames, &opened);
+}
+
+int json_parser_close(p_json_parser t_parser)
+{
+	if (!json_close_frame(&t_parser->values, t_parser->json, json_parser_top(t_parser)))
+	{
+		return 0;
+	}
+	--t_parser->frames.element_count;
+	return 1;
+}
+
+int json_parser_start_object(void* t_context)
+{
+	return json_parser_open((p_json_parser)t_context, '{');
+}
+
+int json_parser_start_array(void* t_context)
+{
+	return json_parser_open((p_json_parser)t_context, '[');
+}
+
+int json_parser_end_container(void* t_context)
+{
+	return json_parser_close((p_json_parser)t_context);
+}
+
+int json_parser_key(void* t_context, const json_string* t_key)
+{
+	p_json_parser parser = (p_json_parser)t_context;
+	json_string name;
+	
+	name.data = (void*)json_intern_find(parser->json, (const char*)t_key->data, t_key->size);
+	name.size = t_key->size;
+	
+	return (name.data || json_parser_copy_string(parser, t_key, &name)) && json_begin_property(parser->json, json_parser_top(parser), &name);
+}
+
+int json_parser_value(void* t_context, const json_value* t_value)
+{
+	p_json_parser parser = (p_json_parser)t_context;
+	
+	if (t_value->type != json_data_type_string)
+	{
+		return json_parser_emit(parser, t_value);
+	}
+	
+	json_string* string = (json_string*)arena_alloc(&parser->json->arena, sizeof(json_string));
+	if (!string || !json_parser_copy_string(parser, &t_value->value.blob->string, string))
+	{
+		JSON_LOG("failed to copy string");
+		return 0;
+	}
+	
+	json_value value;
+	value.type = json_data_type_string;
+	value.value.blob = (p_json_blob)string;
+	return json_parser_emit(parser, &value);
+}
+
+int json_parser_init(json_parser* t_parser, json_file* t_json)
+{
+	assert(t_parser && t_json);
+	
+	json_reader_callbacks callbacks;
+	callbacks.start_object = json_parser_start_object;
+	callbacks.end_object = json_parser_end_container;
+	callbacks.start_array = json_parser_start_array;
+	callbacks.end_array = json_parser_end_container;
+	callbacks.key = json_parser_key;
+	callbacks.value = json_parser_value;
+	
+	if (!json_reader_init(&t_parser->reader, &callbacks, t_parser))
+	{
+		return 0;
+	}
+	if (!vector_init(&t_parser->frames, sizeof(json_frame)))
+	{
+		JSON_LOG("failed to init frame stack");
+		json_reader_final(&t_parser->reader);
+		return 0;
+	}
+	if (!vector_init(&t_parser->values, sizeof(json_value)))
+	{
+		JSON_LOG("failed to init value stack");
+		vector_final(&t_parser->frames);
+		json_reader_final(&t_parser->reader);
+		return 0;
+	}
+	if (!arena_init(&t_json->arena, JSON_ARENA_CHUNK_SIZE))
+	{
+		JSON_LOG("failed to init arena");
+		vector_final(&t_parser->values);
+		vector_final(&t_parser->frames);
+		json_reader_final(&t_parser->reader);
+		return 0;
+	}
+	
+	/* keys are interned so that repeated names are copied out of the reader once */
+	
+	if (!json_key_table_init(&t_json->keys))
+	{
+		JSON_LOG("failed to init key table");
+		arena_final(&t_json->arena);
+		vector_final(&t_parser->values);
+		vector_final(&t_parser->frames);
+		json_reader_final(&t_parser->reader);
+		return 0;
+	}
+	
+	t_json->source.data = 0;
+	t_json->source.size = 0;
+	t_json->source.is_mapped = 0;
+	t_json->source.is_allocated = 0;
+	memset(&t_json->spans, 0, sizeof(t_json->spans));
+	
+	t_parser->json = t_json;
+	t_parser->root = json_undefined;
+	t_parser->is_finished = 0;
+	
+	return 1;
+}
+
+void json_parser_final(json_parser* t_parser)
+{
+	assert(t_parser);
+	
+	/* an unfinished json file is never handed over, so its partial tree goes with the parser */
+	
+	if (!t_parser->is_finished)
+	{
+		json_span_table_final(&t_parser->json->spans);
+		json_key_table_final(&t_parser->json->keys);
+		arena_final(&t_parser->json->arena);
+	}
+	vector_final(&t_parser->values);
+	vector_final(&t_parser->frames);
+	json_reader_final(&t_parser->reader);
+}
+
+int json_parser_feed(json_parser* t_parser, const char* t_data, size_t t_size)
+{
+	assert(t_parser && !t_parser->is_finished);
+	
+	return json_reader_feed(&t_parser->reader, t_data, t_size);
+}
+
+int json_parser_finish(json_parser* t_parser)
+{
+	assert(t_parser && !t_parser->is_finished);
+	
+	if (!json_reader_finish(&t_parser->reader) || t_parser->root.type != json_data_type_object)
+	{
+		JSON_LOG("failed to read root object");
+		return 0;
+	}
+	
+	t_parser->json->root = t_parser->root.value.blob->object;
+	t_parser->is_finished = 1;
+	
+	return 1;
+}
+
+#if !JSON_DEBUG_LOG_STRINGIFY
+#undef JSON_LOG
+#define JSON_LOG(...) JSON_NOP
+#else
+#undef JSON_LOG
+#define JSON_LOG(...) JSON_LOG_DEFINITION(__VA_ARGS__)
+#endif
+
+typedef struct
+{
+	unsigned long long int f;
+	int e;
+} json_diy_fp;
+
+json_diy_fp json_diy_fp_make(unsigned long long int t_f, int t_e)
+{
+	json_diy_fp result;
+	result.f = t_f;
+	result.e = t_e;
+	return result;
+}
+
+json_diy_fp json_diy_fp_multiply(json_diy_fp t_a, json_diy_fp t_b)
+{
+	/* the high half of the product, rounded */
+	
+	unsigned long long int high;
+	unsigned long long int low = json_multiply_128(t_a.f, t_b.f, &high);
+	return json_diy_fp_make(high + (low >> 63), t_a.e + t_b.e + 64);
+}
+
+json_diy_fp json_diy_fp_normalize(json_diy_fp t_a)
+{
+	unsigned int zeros = json_leading_zeros(t_a.f);
+	return json_diy_fp_make(t_a.f << zeros, t_a.e - (int)zeros);
+}
+
+unsigned int json_format_integer(unsigned long long int t_value, char* t_out)
+{
+	/* digits are written backwards then reversed into place */
+	
+	char digits[20];
+	unsigned int count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + t_value % 10);
+		t_value /= 10;
+	}
+	while (t_value);
+	
+	unsigned int i = 0;
+	for (; i < count; ++i)
+	{
+		t_out[i] = digits[count - 1 - i];
+	}
+	return count;
+}
+
+void json_grisu_round(char* t_digits, unsigned int t_length, unsigned long long int t_distance, unsigned long long int t_delta, unsigned long long int t_rest, unsigned long long int t_ten_k)
+{
+	/* step the last digit down while that moves closer to the exact value and stays inside the rounding interval */
+	
+	while (t_rest < t_distance && t_delta - t_rest >= t_ten_k && (t_rest + t_ten_k < t_distance || t_distance - t_rest > t_rest + t_ten_k - t_distance))
+	{
+		--t_digits[t_length - 1];
+		t_rest += t_ten_k;
+	}
+}
+
+unsigned int json_grisu(double t_number, char* t_digits, int* t_out_exponent)
+{
+	/* grisu2, finds a short digit string that reads back as t_number, for positive finite t_number */
+	
+	unsigned long long int bits;
+	memcpy(&bits, &t_number, sizeof(bits));
+	
+	unsigned long long int fraction = bits & (((unsigned long long int)1 << 52) - 1);
+	int biased = (int)(bits >> 52);
+	json_diy_fp value = biased ? json_diy_fp_make(fraction | ((unsigned long long int)1 << 52), biased - 1075) : json_diy_fp_make(fraction, -1074);
+	
+	/* the boundaries are halfway to the neighbouring doubles, the lower one is closer at powers of two */
+	
+	json_diy_fp upper = json_diy_fp_normalize(json_diy_fp_make(2 * value.f + 1, value.e - 1));
+	json_diy_fp lower = fraction == 0 && biased > 1 ? json_diy_fp_make(4 * value.f - 1, value.e - 2) : json_diy_fp_make(2 * value.f - 1, value.e - 1);
+	lower = json_diy_fp_make(lower.f << (lower.e - upper.e), upper.e);
+	value = json_diy_fp_normalize(value);
+	
+	/* scale by a cached power of ten so the upper boundary's exponent lands in [-60, -32] */
+	
+	int f = -61 - upper.e;
+	int k = (f * 78913) / (1 << 18) + (f > 0);
+	const json_cached_power* cached = &json_cached_powers[(-json_cached_powers_min + k + (json_cached_powers_step - 1)) / json_cached_powers_step];
+	json_diy_fp power = json_diy_fp_make(cached->significand, cached->binary_exponent);
+	
+	json_diy_fp w = json_diy_fp_multiply(value, power);
+	json_diy_fp w_lower = json_diy_fp_multiply(lower, power);
+	json_diy_fp w_upper = json_diy_fp_multiply(upper, power);
+	++w_lower.f;
+	--w_upper.f;
+	
+	int exponent = -cached->decimal_exponent;
+	unsigned long long int delta = w_upper.f - w_lower.f;
+	unsigned long long int distance = w_upper.f - w.f;
+	
+	unsigned int shift = (unsigned int)-w_upper.e;
+	unsigned long long int one = (unsigned long long int)1 << shift;
+	unsigned int integral = (unsigned int)(w_upper.f >> shift);
+	unsigned long long int fractional = w_upper.f & (one - 1);
+	
+	/* integral digits first */
+	
+	unsigned int power10 = 1000000000;
+	unsigned int n = 10;
+	while (power10 > integral && n > 1)
+	{
+		power10 /= 10;
+		--n;
+	}
+	
+	unsigned int length = 0;
+	while (n > 0)
+	{
+		t_digits[length++] = (char)('0' + integral / power10);
+		integral %= power10;
+		--n;
+		
+		unsigned long long int rest = ((unsigned long long int)integral << shift) + fractional;
+		if (rest <= delta)
+		{
+			*t_out_exponent = exponent + (int)n;
+			json_grisu_round(t_digits, length, distance, delta, rest, (unsigned long long int)power10 << shift);
+			return length;
+		}
+		power10 /= 10;
+	}
+	
+	/* then fractional digits until inside the interval */
+	
+	int m = 0;
+	for (;;)
+	{
+		fractional *= 10;
+		t_digits[length++] = (char)('0' + (fractional >> shift));
+		fractional &= one - 1;
+		++m;
+		delta *= 10;
+		distance *= 10;
+		if (fractional <= delta)
+		{
+			break;
+		}
+	}
+	
+	*t_out_exponent = exponent - m;
+	json_grisu_round(t_digits, length, distance, delta, fractional, one);
+	return length;
+}
+
+unsigned int json_format_number(double t_number, char* t_out)
+{
+	/* writes the shortest text that reads back as t_number into at least 32 bytes at t_out, integral values are written as integers */
+	
+	char* c = t_out;
+	
+	if (t_number != t_number || t_number - t_number != 0.0)
+	{
+		/* json has no nan or infinity */
+		
+		memcpy(c, "null", 4);
+		return 4;
+	}
+	if (signbit(t_number))
+	{
+		*c++ = '-';
+		t_number = -t_number;
+	}
+	if (t_number < 9007199254740992.0 && t_number == (double)(unsigned long long int)t_number)
+	{
+		return (unsigned int)(c - t_out) + json_format_integer((unsigned long long int)t_number, c);
+	}
+	
+	int exponent;
+	unsigned int length = json_grisu(t_number, c, &exponent);
+	int point = (int)length + exponent;
+	
+	if (point > 0 && point <= 21 && exponent >= 0)
+	{
+		/* digits then zeros */
+		
+		memset(c + length, '0', (size_t)exponent);
+		c += point;
+	}
+	else if (point > 0 && point <= 21)
+	{
+		/* digits with a point inside */
+		
+		memmove(c + point + 1, c + point, length - (unsigned int)point);
+		c[point] = '.';
+		c += length + 1;
+	}
+	else if (point > -6 && point <= 0)
+	{
+		/* leading zeros after the point */
+		
+		memmove(c + 2 - point, c, length);
+		c[0] = '0';
+		c[1] = '.';
+		memset(c + 2, '0', (size_t)-point);
+		c += 2 - point + length;
+	}
+	else
+	{
+		/* scientific */
+		
+		if (length > 1)
+		{
+			memmove(c + 2, c + 1, length - 1);
+			c[1] = '.';
+			c += length + 1;
+		}
+		else
+		{
+			++c;
+		}
+		*c++ = 'e';
+		int scientific = point - 1;
+		if (scientific < 0)
+		{
+			*c++ = '-';
+			scientific = -scientific;
+		}
+		c += json_format_integer((unsigned long long int)scientific, c);
+	}
+	
+	return (unsigned int)(c - t_out);
+}
+
+/* control characters without a short escape are written as \u00XX */
+const char json_escape_characters[256] =
+{
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+	'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+	['"'] = '"', ['\\'] = '\\'
+};
+
+const char* json_find_escape(const char* t_c, const char* t_end)
+{
+#if JSON_SIMD_SSE2
+	
+	/* quotes, backslashes and control characters are picked out sixteen at a time, all of them need escaping */
+	
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+	const __m128i control = _mm_set1_epi8(0x1f);
+	
+	for (; t_end - t_c >= 16; t_c += 16)
+	{
+		__m128i block = _mm_loadu_si128((const __m128i*)t_c);
+		__m128i is_special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)), _mm_cmpeq_epi8(_mm_max_epu8(block, control), control));
+		json_mask mask = (json_mask)(unsigned int)_mm_movemask_epi8(is_special);
+		
+		if (mask)
+		{
+			return t_c + json_trailing_zeros(mask);
+		}
+	}
+
+#endif
+	
+	while (t_c != t_end && !json_escape_characters[(unsigned char)*t_c])
+	{
+		++t_c;
+	}
+	return t_c;
+}
+
+void json_write_options_init(json_write_options* t_options)
+{
+	assert(t_options);
+	
+	t_options->is_compact = 0;
+	t_options->indent = 0;
+	t_options->is_verbatim = 0;
+}
+
+int json_writer_init(json_writer* t_writer, size_t t_capacity)
+{
+	assert(t_writer);
+	
+	t_writer->write = 0;
+	t_writer->context = 0;
+	t_writer->capacity = t_capacity ? t_capacity : 64;
+	t_writer->size = 0;
+	t_writer->is_failed = 0;
+	json_write_options_init(&t_writer->options);
+	t_writer->spans = 0;
+	t_writer->data = (char*)malloc(t_writer->capacity);
+	
+	return t_writer->data ? 1 : 0;
+}
+
+int json_writer_init_with_func(json_writer* t_writer, json_write_func t_write, void* t_context)
+{
+	assert(t_writer && t_write);
+	
+	if (!json_writer_init(t_writer, JSON_WRITER_BUFFER_SIZE))
+	{
+		return 0;
+	}
+	
+	t_writer->write = t_write;
+	t_writer->context = t_context;
+	
+	return 1;
+}
+
+int json_write_file_func(void* t_context, const char* t_data, size_t t_size)
+{
+	return fwrite(t_data, 1, t_size, (FILE*)t_context) == t_size;
+}
+
+int json_writer_init_with_file(json_writer* t_writer, FILE* t_file)
+{
+	assert(t_file);
+	
+	return json_writer_init_with_func(t_writer, json_write_file_func, t_file);
+}
+
+void json_writer_final(json_writer* t_writer)
+{
+	assert(t_writer);
+	
+	free(t_writer->data);
+	t_writer->data = 0;
+	t_writer->size = 0;
+	t_writer->capacity = 0;
+}
+
+int json_writer_flush(json_writer* t_writer)
+{
+	assert(t_writer);
+	
+	if (t_writer->is_failed)
+	{
+		return 0;
+	}
+	if (t_writer->write && t_writer->size)
+	{
+		if (!t_writer->write(t_writer->context, t_writer->data, t_writer->size))
+		{
+			JSON_LOG("write function failed");
+			t_writer->is_failed = 1;
+			return 0;
+		}
+		t_writer->size = 0;
+	}
+	return 1;
+}
+
+int json_writer_grow(p_json_writer t_writer, size_t t_size)
+{
+	/* makes room for t_size more bytes in a writer that keeps its text in memory */
+	
+	size_t capacity = t_writer->capacity;
+	while (capacity - t_writer->size < t_size)
+	{
+		capacity *= 2;
+	}
+	if (capacity == t_writer->capacity)
+	{
+		return 1;
+	}
+	
+	char* data = (char*)realloc(t_writer->data, capacity);
+	if (!data)
+	{
+		JSON_LOG("failed to grow writer");
+		t_writer->is_failed = 1;
+		return 0;
+	}
+	t_writer->data = data;
+	t_writer->capacity = capacity;
+	return 1;
+}
+
+int json_writer_append(p_json_writer t_writer, const char* t_data, size_t t_size)
+{
+	if (t_writer->capacity - t_writer->size < t_size)
+	{
+		if (t_writer->write)
+		{
+			/* pass the buffer on, and anything too big for it straight after */
+			
+			if (!json_writer_flush(t_writer))
+			{
+				return 0;
+			}
+			if (t_size > t_writer->capacity)
+			{
+				if (!t_writer->write(t_writer->context, t_data, t_size))
+				{
+					JSON_LOG("write function failed");
+					t_writer->is_failed = 1;
+					return 0;
+				}
+				return 1;
+			}
+		}
+		else if (!json_writer_grow(t_writer, t_size))
+		{
+			return 0;
+		}
+	}
+	
+	memcpy(t_writer->data + t_writer->size, t_data, t_size);
+	t_writer->size += t_size;
+	return 1;
+}
+
+int json_write_string(p_json_writer t_writer, const char* t_string, size_t t_length)
+{
+	/* runs without escapes are copied whole */
+	
+	const char* c = t_string;
+	const char* end = t_string + t_length;
+	
+	if (!json_writer_append(t_writer, "\"", 1))
+	{
+		return 0;
+	}
+	while (c != end)
+	{
+		const char* escape = json_find_escape(c, end);
+		if (!json_writer_append(t_writer, c, (size_t)(escape - c)))
+		{
+			return 0;
+		}
+		if (escape == end)
+		{
+			break;
+		}
+		
+		static const char hex[] = "0123456789abcdef";
+		char escaped[6] = { '\\', json_escape_characters[(unsigned char)*escape], '0', '0', hex[(unsigned char)*escape >> 4], hex[*escape & 0xf] };
+		if (!json_writer_append(t_writer, escaped, escaped[1] == 'u' ? 6 : 2))
+		{
+			return 0;
+		}
+		c = escape + 1;
+	}
+	return json_writer_append(t_writer, "\"", 1);
+}
+
+size_t json_estimate_size(const json_value* t_value)
+{
+	assert(t_value);
+	
+	switch (t_value->type)
+	{
+	case json_data_type_object:
+	{
+		const json_object* object = &t_value->value.blob->object;
+		size_t size = 3;
+		unsigned int i = 0;
+		for (; i < object->properties.element_count; ++i)
+		{
+			const json_property* property = (const json_property*)object->properties.buffer.data + i;
+			size += property->key_length + 7 + json_estimate_size(&property->value);
+		}
+		return size;
+	}
+	case json_data_type_array:
+	{
+		const json_array* array = &t_value->value.blob->array;
+		size_t size = 3;
+		unsigned int i = 0;
+		for (; i < array->element_count; ++i)
+		{
+			size += 2 + json_estimate_size((const json_value*)array->buffer.data + i);
+		}
+		return size;
+	}
+	case json_data_type_string:
+		return t_value->value.blob->string.size + 2;
+	case json_data_type_number:
+	case json_data_type_integer:
+		return 24;
+	case json_data_type_boolean:
+		return 5;
+	default:
+		return 4;
+	}
+}
+
+int json_write_line(p_json_writer t_writer, unsigned int t_depth)
+{
+	/* pretty output starts each line indented by depth */
+	
+	static const char spaces[] = "\n                                                               ";
+	size_t count = (size_t)t_depth * t_writer->options.indent;
+	
+	if (!json_writer_append(t_writer, spaces, 1 + (count < 63 ? count : 63)))
+	{
+		return 0;
+	}
+	for (count = count < 63 ? 0 : count - 63; count; )
+	{
+		size_t step = count < 63 ? count : 63;
+		if (!json_writer_append(t_writer, spaces + 1, step))
+		{
+			return 0;
+		}
+		count -= step;
+	}
+	return 1;
+}
+
+int json_write_value_at(p_json_writer t_writer, const json_value* t_value, unsigned int t_depth)
+{
+	const int is_pretty = !t_writer->options.is_compact;
+	
+	if (t_writer->spans && (t_value->type == json_data_type_object || t_value->type == json_data_type_array))
+	{
+		/* with is_verbatim, containers untouched since loading are copied from the text in whatever format it had, the root is the only one written at depth 0 */
+		
+		const json_span* span = t_depth ? json_span_table_find(t_writer->spans, t_value->value.blob) : &t_writer->spans->root;
+		if (span && span->length && !span->is_dirty)
+		{
+			return json_writer_append(t_writer, span->text, span->length);
+		}
+	}
+	
+	if (t_value->type == json_data_type_object)
+	{
+		const json_object* object = &t_value->value.blob->object;
+		
+		if (!json_writer_append(t_writer, "{", 1))
+		{
+			JSON_LOG("failed to write object open brace");
+			return 0;
+		}
+		
+		/* properties are written in the order they were read or added */
+		
+		unsigned int i = 0;
+		for (; i < object->properties.element_count; ++i)
+		{
+			const json_property* property = (const json_property*)object->properties.buffer.data + i;
+			
+			if ((i && !json_writer_append(t_writer, ",", 1)) || (is_pretty && !json_write_line(t_writer, t_depth + 1)))
+			{
+				JSON_LOG("failed to write separator");
+				return 0;
+			}
+			if (!json_write_string(t_writer, property->key, property->key_length) || !(is_pretty ? json_writer_append(t_writer, " : ", 3) : json_writer_append(t_writer, ":", 1)))
+			{
+				JSON_LOG("failed to write property name");
+				return 0;
+			}
+			if (!json_write_value_at(t_writer, &property->value, t_depth + 1))
+			{
+				JSON_LOG("failed to write property value");
+				return 0;
+			}
+		}
+		
+		if ((is_pretty && !json_write_line(t_writer, t_depth)) || !json_writer_append(t_writer, "}", 1))
+		{
+			JSON_LOG("failed to write object close brace");
+			return 0;
+		}
+	}
+	else if (t_value->type == json_data_type_array)
+	{
+		const json_array* array = &t_value->value.blob->array;
+		
+		if (!json_writer_append(t_writer, "[", 1))
+		{
+			JSON_LOG("failed to write array open brace");
+			return 0;
+		}
+		
+		unsigned int i = 0;
+		for (; i < array->element_count; ++i)
+		{
+			if ((i && !json_writer_append(t_writer, ",", 1)) || (is_pretty && !json_write_line(t_writer, t_depth + 1)))
+			{
+				JSON_LOG("failed to write separator");
+				return 0;
+			}
+			if (!json_write_value_at(t_writer, (const json_value*)array->buffer.data + i, t_depth + 1))
+			{
+				JSON_LOG("failed to write array value");
+				return 0;
+			}
+		}
+		
+		if ((is_pretty && !json_write_line(t_writer, t_depth)) || !json_writer_append(t_writer, "]", 1))
+		{
+			JSON_LOG("failed to write array close brace");
+			return 0;
+		}
+	}
+	else if (t_value->type == json_data_type_string)
+	{
+		if (!json_write_string(t_writer, (const char*)t_value->value.blob->string.data, t_value->value.blob->string.size))
+		{
+			JSON_LOG("failed to write string");
+			return 0;
+		}
+	}
+	else if (t_value->type == json_data_type_boolean)
+	{
+		if (!(t_value->value.boolean ? json_writer_append(t_writer, "true", 4) : json_writer_append(t_writer, "false", 5)))
+		{
+			JSON_LOG("failed to write boolean");
+			return 0;
+		}
+	}
+	else if (t_value->type == json_data_type_integer)
+	{
+		char s[32];
+		unsigned long long int magnitude = (unsigned long long int)t_value->value.integer;
+		unsigned int length = 0;
+		if (t_value->value.integer < 0)
+		{
+			s[length++] = '-';
+			magnitude = 0 - magnitude;
+		}
+		length += json_format_integer(magnitude, s + length);
+		if (!json_writer_append(t_writer, s, length))
+		{
+			JSON_LOG("failed to write integer");
+			return 0;
+		}
+	}
+	else if (t_value->type == json_data_type_number)
+	{
+		char s[32];
+		if (!json_writer_append(t_writer, s, json_format_number(t_value->value.number, s)))
+		{
+			JSON_LOG("failed to write number");
+			return 0;
+		}
+	}
+	else
+	{
+		if (!json_writer_append(t_writer, "null", 4))
+		{
+			JSON_LOG("failed to write null");
+			return 0;
+		}
+	}
+	
+	return 1;
+}
+
+int json_write_value(json_writer* t_writer, const json_value* t_value)
+{
+	assert(t_writer);
+	assert(t_value);
+	
+	return json_write_value_at(t_writer, t_value, 0);
+}
+
+int json_write(json_writer* t_writer, const json_file* t_json)
+{
+	assert(t_writer);
+	assert(t_json);
+	
+	json_value root;
+	root.type = json_data_type_object;
+	root.value.blob = (p_json_blob)&t_json->root;
+	
+	t_writer->spans = t_json->spans.slots && t_writer->options.is_verbatim ? &t_json->spans : 0;
+	int result = json_write_value(t_writer, &root) && json_writer_flush(t_writer);
+	t_writer->spans = 0;
+	
+	return result;
+}
+
+int json_stringify_value_func(void* t_context, const char* t_data, size_t t_size)
+{
+	return vector_push_many((p_vector)t_context, t_data, (unsigned int)t_size);
+}
+
+int json_stringify_value_with_options(json_value* t_value, vector* t_string, const json_write_options* t_options)
+{
+	assert(t_value);
+	assert(t_string);
+	assert(t_options);
+	
+	json_writer writer;
+	if (!json_writer_init_with_func(&writer, json_stringify_value_func, t_string))
+	{
+		JSON_LOG("failed to initialize writer");
+		return 0;
+	}
+	writer.options = *t_options;
+	
+	int result = json_write_value(&writer, t_value) && json_writer_flush(&writer);
+	
+	json_writer_final(&writer);
+	
+	return result;
+}
+
+int json_stringify_value(json_value* t_value, vector* t_string)
+{
+	json_write_options options;
+	json_write_options_init(&options);
+	
+	return json_stringify_value_with_options(t_value, t_string, &options);
+}
+
+int json_stringify_with_options(json_file* t_json, buffer* t_out_string, const json_write_options* t_options)
+{
+	assert(t_json);
+	assert(t_out_string);
+	assert(t_options);
+	
+	JSON_LOG("begin stringify");
+	
+	json_value root;
+	root.type = json_data_type_object;
+	root.value.blob = (p_json_blob)&t_json->root;
+	
+	/* sized up front so the text is written without regrowing */
+	
+	json_writer writer;
+	if (!json_writer_init(&writer, json_estimate_size(&root) + 1))
+	{
+		JSON_LOG("failed to initialize writer");
+		return 0;
+	}
+	writer.options = *t_options;
+	writer.spans = t_json->spans.slots && t_options->is_verbatim ? &t_json->spans : 0;
+	
+	if (!json_write_value(&writer, &root) || !json_writer_append(&writer, "", 1))
+	{
+		json_writer_final(&writer);
+		JSON_LOG("failed to stringify root value");
+		return 0;
+	}
+	
+	t_out_string->data = writer.data;
+	t_out_string->size = writer.size - 1;
+	
+	JSON_LOG("succeeded stringify");
+	
+	return 1;
+}
+
+int json_stringify(json_file* t_json, buffer* t_out_string)
+{
+	json_write_options options;
+	json_write_options_init(&options);
+	
+	return json_stringify_with_options(t_json, t_out_string, &options);
+}
+
+#define json_cbor_major_unsigned 0
+#define json_cbor_major_negative 1
+#define json_cbor_major_bytes 2
+#define json_cbor_major_text 3
+#define json_cbor_major_array 4
+#define json_cbor_major_map 5
+#define json_cbor_major_tag 6
+#define json_cbor_major_simple 7
+
+#define json_cbor_false 0xf4
+#define json_cbor_true 0xf5
+#define json_cbor_null 0xf6
+#define json_cbor_undefined 0xf7
+#define json_cbor_half 0xf9
+#define json_cbor_float 0xfa
+#define json_cbor_double 0xfb
+#define json_cbor_break 0xff
+#define json_cbor_indefinite 31
+
+int json_write_cbor_head(p_json_writer t_writer, unsigned int t_major, unsigned long long int t_argument)
+{
+	/* arguments are stored in the fewest big endian bytes that hold them */
+	
+	unsigned char head[9];
+	unsigned int size = 0;
+	unsigned int i = 0;
+	
+	if (t_argument < 24)
+	{
+		head[0] = (unsigned char)((t_major << 5) | t_argument);
+		return json_writer_append(t_writer, (const char*)head, 1);
+	}
+	
+	size = t_argument <= 0xff ? 1 : t_argument <= 0xffff ? 2 : t_argument <= 0xffffffff ? 4 : 8;
+	head[0] = (unsigned char)((t_major << 5) | (size == 1 ? 24 : size == 2 ? 25 : size == 4 ? 26 : 27));
+	for (i = 0; i < size; ++i)
+	{
+		head[size - i] = (unsigned char)(t_argument >> (i * 8));
+	}
+	return json_writer_append(t_writer, (const char*)head, size + 1);
+}
+
+int json_write_cbor_number(p_json_writer t_writer, double t_number)
+{
+	/* integral numbers are written as integers, others as the narrowest float that holds them exactly */
+	
+	if (t_number == floor(t_number) && fabs(t_number) < 9007199254740992.0 && !(t_number == 0.0 && signbit(t_number)))
+	{
+		return t_number < 0.0
+			? json_write_cbor_head(t_writer, json_cbor_major_negative, (unsigned long long int)(-1.0 - t_number))
+			: json_write_cbor_head(t_writer, json_cbor_major_unsigned, (unsigned long long int)t_number);
+	}
+	
+	unsigned char bytes[9];
+	unsigned int size = 8;
+	unsigned long long int bits = 0;
+	
+	/* infinities and nan are single floats, finite numbers are only narrowed when a float can hold their magnitude, the cast being undefined otherwise */
+	
+	int is_single = 0;
+	float single = 0.0f;
+	if (isnan(t_number))
+	{
+		single = NAN;
+		is_single = 1;
+	}
+	else if (isinf(t_number))
+	{
+		single = t_number < 0.0 ? -INFINITY : INFINITY;
+		is_single = 1;
+	}
+	else if (fabs(t_number) <= FLT_MAX)
+	{
+		single = (float)t_number;
+		is_single = (double)single == t_number;
+	}
+	
+	if (is_single)
+	{
+		unsigned int single_bits = 0;
+		memcpy(&single_bits, &single, sizeof(single_bits));
+		bits = single_bits;
+		size = 4;
+		bytes[0] = json_cbor_float;
+	}
+	else
+	{
+		memcpy(&bits, &t_number, sizeof(bits));
+		bytes[0] = json_cbor_double;
+	}
+	
+	unsigned int i = 0;
+	for (; i < size; ++i)
+	{
+		bytes[size - i] = (unsigned char)(bits >> (i * 8));
+	}
+	return json_writer_append(t_writer, (const char*)bytes, size + 1);
+}
+
+int json_write_cbor_value(json_writer* t_writer, const json_value* t_value)
+{
+	assert(t_writer);
+	assert(t_value);
+	
+	if (t_value->type == json_data_type_object)
+	{
+		const json_object* object = &t_value->value.blob->object;
+		
+		if (!json_write_cbor_head(t_writer, json_cbor_major_map, object->properties.element_count))
+		{
+			JSON_LOG("failed to write map head");
+			return 0;
+		}
+		
+		unsigned int i = 0;
+		for (; i < object->properties.element_count; ++i)
+		{
+			const json_property* property = (const json_property*)object->properties.buffer.data + i;
+			
+			if (!json_write_cbor_head(t_writer, json_cbor_major_text, property->key_length) || !json_writer_append(t_writer, property->key, property->key_length))
+			{
+				JSON_LOG("failed to write property name");
+				return 0;
+			}
+			if (!json_write_cbor_value(t_writer, &property->value))
+			{
+				JSON_LOG("failed to write property value");
+				return 0;
+			}
+		}
+		return 1;
+	}
+	if (t_value->type == json_data_type_array)
+	{
+		const json_array* array = &t_value->value.blob->array;
+		
+		if (!json_write_cbor_head(t_writer, json_cbor_major_array, array->element_count))
+		{
+			JSON_LOG("failed to write array head");
+			return 0;
+		}
+		
+		unsigned int i = 0;
+		for (; i < array->element_count; ++i)
+		{
+			if (!json_write_cbor_value(t_writer, (const json_value*)array->buffer.data + i))
+			{
+				JSON_LOG("failed to write array value");
+				return 0;
+			}
+		}
+		return 1;
+	}
+	if (t_value->type == json_data_type_string)
+	{
+		const json_string* string = &t_value->value.blob->string;
+		
+		if (!json_write_cbor_head(t_writer, json_cbor_major_text, string->size) || !json_writer_append(t_writer, (const char*)string->data, string->size))
+		{
+			JSON_LOG("failed to write string");
+			return 0;
+		}
+		return 1;
+	}
+	if (t_value->type == json_data_type_integer)
+	{
+		json_integer integer = t_value->value.integer;
+		
+		return integer < 0
+			? json_write_cbor_head(t_writer, json_cbor_major_negative, (unsigned long long int)(-1 - integer))
+			: json_write_cbor_head(t_writer, json_cbor_major_unsigned, (unsigned long long int)integer);
+	}
+	if (t_value->type == json_data_type_number)
+	{
+		return json_write_cbor_number(t_writer, t_value->value.number);
+	}
+	
+	char simple = (char)(t_value->type == json_data_type_boolean ? (t_value->value.boolean ? json_cbor_true : json_cbor_false) : json_cbor_null);
+	return json_writer_append(t_writer, &simple, 1);
+}
+
+int json_write_cbor(json_writer* t_writer, const json_file* t_json)
+{
+	assert(t_writer);
+	assert(t_json);
+	
+	json_value root;
+	root.type = json_data_type_object;
+	root.value.blob = (p_json_blob)&t_json->root;
+	
+	return json_write_cbor_value(t_writer, &root) && json_writer_flush(t_writer);
+}
+
+int json_encode_cbor(json_file* t_json, buffer* t_out_data)
+{
+	assert(t_json);
+	assert(t_out_data);
+	
+	JSON_LOG("begin encode cbor");
+	
+	json_value root;
+	root.type = json_data_type_object;
+	root.value.blob = (p_json_blob)&t_json->root;
+	
+	/* sized from the text estimate, which the binary form seldom exceeds */
+	
+	json_writer writer;
+	if (!json_writer_init(&writer, json_estimate_size(&root)))
+	{
+		JSON_LOG("failed to initialize writer");
+		return 0;
+	}
+	
+	if (!json_write_cbor_value(&writer, &root))
+	{
+		json_writer_final(&writer);
+		JSON_LOG("failed to encode root value");
+		return 0;
+	}
+	
+	t_out_data->data = writer.data;
+	t_out_data->size = writer.size;
+	
+	JSON_LOG("succeeded encode cbor");
+	
+	return 1;
+}
+
+#if !JSON_DEBUG_LOG_LOAD
+#undef JSON_LOG
+#define JSON_LOG(...) JSON_NOP
+#else
+#undef JSON_LOG
+#define JSON_LOG(...) JSON_LOG_DEFINITION(__VA_ARGS__)
+#endif
+
+typedef struct
+{
+	json_frame frame;
+	unsigned long long int remaining;
+	int is_indefinite;
+} json_cbor_frame, *p_json_cbor_frame;
+
+typedef struct
+{
+	const unsigned char* c;
+	const unsigned char* end;
+	vector values;
+	vector frames;
+	unsigned int max_depth;
+	int exact_integers;
+	int validate_utf8;
+} json_cbor_cursor, *p_json_cbor_cursor;
+
+int json_read_cbor_head(p_json_cbor_cursor t_cursor, unsigned int* t_out_major, unsigned int* t_out_info, unsigned long long int* t_out_argument)
+{
+	if (t_cursor->c == t_cursor->end)
+	{
+		JSON_LOG("unexpected end of data");
+		return 0;
+	}
+	
+	unsigned int info = *t_cursor->c & 0x1f;
+	unsigned int size = info < 24 ? 0 : info == 24 ? 1 : info == 25 ? 2 : info == 26 ? 4 : info == 27 ? 8 : 0;
+	
+	*t_out_major = *t_cursor->c++ >> 5;
+	*t_out_info = info;
+	*t_out_argument = info < 24 ? info : 0;
+	
+	if ((info >= 28 && info != json_cbor_indefinite) || (info == json_cbor_indefinite && (*t_out_major < json_cbor_major_bytes || *t_out_major == json_cbor_major_tag)))
+	{
+		JSON_LOG("malformed head");
+		return 0;
+	}
+	if ((size_t)(t_cursor->end - t_cursor->c) < size)
+	{
+		JSON_LOG("unexpected end of data");
+		return 0;
+	}
+	for (; size; --size)
+	{
+		*t_out_argument = (*t_out_argument << 8) | *t_cursor->c++;
+	}
+	return 1;
+}
+
+int json_read_cbor_string(p_json_cbor_cursor t_cursor, unsigned int t_major, unsigned int t_info, unsigned long long int t_length, json_string* t_out_string)
+{
+	/* strings are left in place in the data */
+	
+	if (t_info == json_cbor_indefinite)
+	{
+		JSON_LOG("indefinite length strings are not supported");
+		return 0;
+	}
+	if ((unsigned long long int)(t_cursor->end - t_cursor->c) < t_length)
+	{
+		JSON_LOG("string runs past end of data");
+		return 0;
+	}
+	if (t_major == json_cbor_major_text && t_cursor->validate_utf8 && !json_validate_utf8((const char*)t_cursor->c, (const char*)t_cursor->c + t_length))
+	{
+		JSON_LOG("text is not valid utf-8");
+		return 0;
+	}
+	
+	t_out_string->data = (void*)t_cursor->c;
+	t_out_string->size = (size_t)t_length;
+	t_cursor->c += t_length;
+	return 1;
+}
+
+double json_cbor_half_to_double(unsigned int t_half)
+{
+	unsigned int exponent = (t_half >> 10) & 0x1f;
+	unsigned int mantissa = t_half & 0x3ff;
+	double number = exponent == 0 ? ldexp(mantissa, -24) : exponent != 31 ? ldexp(mantissa + 1024, (int)exponent - 25) : mantissa == 0 ? HUGE_VAL : NAN;
+	
+	return (t_half & 0x8000) ? -number : number;
+}
+
+int json_read_cbor_scalar(p_json_cbor_cursor t_cursor, json_file* t_json, unsigned int t_major, unsigned int t_info, unsigned long long int t_argument, json_value* t_out_value)
+{
+	switch (t_major)
+	{
+	case json_cbor_major_unsigned:
+	case json_cbor_major_negative:
+	{
+		/* integers beyond the exact range of a double are kept whole when asked */
+		
+		if (t_cursor->exact_integers && t_argument > 9007199254740992ULL && t_argument <= 0x7fffffffffffffffULL)
+		{
+			t_out_value->type = json_data_type_integer;
+			t_out_value->value.integer = t_major == json_cbor_major_unsigned ? (json_integer)t_argument : -1 - (json_integer)t_argument;
+			return 1;
+		}
+		
+		t_out_value->type = json_data_type_number;
+		t_out_value->value.number = t_major == json_cbor_major_unsigned ? (double)t_argument : -1.0 - (double)t_argument;
+		return 1;
+	}
+	case json_cbor_major_bytes:
+	case json_cbor_major_text:
+	{
+		json_string* string = (json_string*)arena_alloc(&t_json->arena, sizeof(json_string));
+		
+		if (!string || !json_read_cbor_string(t_cursor, t_major, t_info, t_argument, string))
+		{
+			JSON_LOG("failed to read string");
+			return 0;
+		}
+		
+		t_out_value->type = json_data_type_string;
+		t_out_value->value.blob = (p_json_blob)string;
+		return 1;
+	}
+	case json_cbor_major_simple:
+	{
+		if (t_info == (json_cbor_false & 0x1f) || t_info == (json_cbor_true & 0x1f))
+		{
+			t_out_value->type = json_data_type_boolean;
+			t_out_value->value.boolean = t_info == (json_cbor_true & 0x1f);
+			return 1;
+		}
+		if (t_info == (json_cbor_null & 0x1f) || t_info == (json_cbor_undefined & 0x1f))
+		{
+			t_out_value->type = json_data_type_null;
+			t_out_value->value.null = 0;
+			return 1;
+		}
+		
+		t_out_value->type = json_data_type_number;
+		if (t_info == (json_cbor_half & 0x1f))
+		{
+			t_out_value->value.number = json_cbor_half_to_double((unsigned int)t_argument);
+			return 1;
+		}
+		if (t_info == (json_cbor_float & 0x1f))
+		{
+			unsigned int bits = (unsigned int)t_argument;
+			float single;
+			memcpy(&single, &bits, sizeof(single));
+			t_out_value->value.number = single;
+			return 1;
+		}
+		if (t_info == (json_cbor_double & 0x1f))
+		{
+			memcpy(&t_out_value->value.number, &t_argument, sizeof(double));
+			return 1;
+		}
+		
+		JSON_LOG("unsupported simple value");
+		return 0;
+	}
+	default:
+	{
+		JSON_LOG("unexpected major type");
+		return 0;
+	}
+	}
+}
+
+int json_read_cbor_value(p_json_cbor_cursor t_cursor, json_file* t_json, json_value* t_out_value)
+{
+	assert(t_cursor);
+	assert(t_json);
+	assert(t_out_value);
+	
+	JSON_LOG("begin read cbor value");
+	
+	*t_out_value = json_undefined;
+	
+	/* containers are tracked on a frame stack as in json_read_value, each counting down the entries left to read */
+	
+	p_json_cbor_frame frame = 0;
+	unsigned int major = 0;
+	unsigned int info = 0;
+	unsigned long long int argument = 0;
+	
+json_read_cbor_value_next:
+	
+	do
+	{
+		if (!json_read_cbor_head(t_cursor, &major, &info, &argument))
+		{
+			goto json_read_cbor_value_fail;
+		}
+	} while (major == json_cbor_major_tag);
+	
+	json_value value = json_undefined;
+	
+	if (major == json_cbor_major_array || major == json_cbor_major_map)
 	{
-		JSON_LOG("failed to read first character");
+		if (t_cursor->frames.element_count >= t_cursor->max_depth)
+		{
+			JSON_LOG("maximum depth exceeded");
+			goto json_read_cbor_value_fail;
+		}
+		
+		if (!json_alloc_container(t_json, major == json_cbor_major_map ? '{' : '[', &value))
+		{
+			goto json_read_cbor_value_fail;
+		}
+		
+		if (!json_emit_value(&t_cursor->values, frame ? &frame->frame : 0, &value, t_out_value))
+		{
+			JSON_LOG("failed to open container");
+			goto json_read_cbor_value_fail;
+		}
+		
+		json_cbor_frame opened;
+		opened.frame.value = value;
+		opened.frame.key = 0;
+		opened.frame.first_value = t_cursor->values.element_count;
+		opened.remaining = argument;
+		opened.is_indefinite = info == json_cbor_indefinite;
+		
+		if (!vector_push(&t_cursor->frames, &opened))
+		{
+			JSON_LOG("failed to push frame");
+			goto json_read_cbor_value_fail;
+		}
+		frame = (p_json_cbor_frame)vector_get_index(&t_cursor->frames, t_cursor->frames.element_count - 1);
+		goto json_read_cbor_value_entry;
+	}
+	
+	if (info == json_cbor_indefinite && major == json_cbor_major_simple)
+	{
+		JSON_LOG("unexpected break");
+		goto json_read_cbor_value_fail;
+	}
+	
+	if (!json_read_cbor_scalar(t_cursor, t_json, major, info, argument, &value) || !json_emit_value(&t_cursor->values, frame ? &frame->frame : 0, &value, t_out_value))
+	{
+		goto json_read_cbor_value_fail;
+	}
+	
+	if (!frame)
+	{
+		JSON_LOG("succeed read cbor value");
+		return 1;
+	}
+	--frame->remaining;
+	
+json_read_cbor_value_entry:
+	
+	if (frame->is_indefinite)
+	{
+		if (t_cursor->c != t_cursor->end && *t_cursor->c == json_cbor_break)
+		{
+			++t_cursor->c;
+			goto json_read_cbor_value_close;
+		}
+	}
+	else if (!frame->remaining)
+	{
+		goto json_read_cbor_value_close;
+	}
+	
+	if (frame->frame.value.type == json_data_type_object)
+	{
+		/* property name */
+		
+		json_string name;
+		
+		do
+		{
+			if (!json_read_cbor_head(t_cursor, &major, &info, &argument))
+			{
+				goto json_read_cbor_value_fail;
+			}
+		} while (major == json_cbor_major_tag);
+		if ((major != json_cbor_major_text && major != json_cbor_major_bytes) || !json_read_cbor_string(t_cursor, major, info, argument, &name))
+		{
+			JSON_LOG("failed to read property name");
+			goto json_read_cbor_value_fail;
+		}
+		if (!json_begin_property(t_json, &frame->frame, &name))
+		{
+			goto json_read_cbor_value_fail;
+		}
+	}
+	goto json_read_cbor_value_next;
+	
+json_read_cbor_value_close:
+	
+	if (!json_close_frame(&t_cursor->values, t_json, &frame->frame))
+	{
+		goto json_read_cbor_value_fail;
+	}
+	
+	--t_cursor->frames.element_count;
+	if (!t_cursor->frames.element_count)
+	{
+		JSON_LOG("succeed read cbor value");
+		return 1;
+	}
+	frame = (p_json_cbor_frame)vector_get_index(&t_cursor->frames, t_cursor->frames.element_count - 1);
+	--frame->remaining;
+	goto json_read_cbor_value_entry;
+	
+json_read_cbor_value_fail:
+	
+	t_cursor->frames.element_count = 0;
+	*t_out_value = json_undefined;
+	return 0;
+}
+
+int json_load_cbor_from_buffer_with_options(json_file* t_json, const char* t_data, size_t t_size, const json_load_options* t_options)
+{
+	assert(t_json && (t_data || !t_size) && t_options);
+	
+	JSON_LOG("begin load cbor from buffer");
+	
+	json_cbor_cursor cursor;
+	if (!vector_init(&cursor.values, sizeof(json_value)))
+	{
+		JSON_LOG("failed to init value stack");
+		return 0;
+	}
+	if (!vector_init(&cursor.frames, sizeof(json_cbor_frame)))
+	{
+		JSON_LOG("failed to init frame stack");
+		vector_final(&cursor.values);
+		return 0;
+	}
+	if (!arena_init(&t_json->arena, JSON_ARENA_CHUNK_SIZE))
+	{
+		JSON_LOG("failed to init arena");
+		vector_final(&cursor.frames);
+		vector_final(&cursor.values);
+		return 0;
+	}
+	
+	memset(&t_json->keys, 0, sizeof(t_json->keys));
+	memset(&t_json->spans, 0, sizeof(t_json->spans));
+	if (t_options->intern_keys && !json_key_table_init(&t_json->keys))
+	{
+		JSON_LOG("failed to init key table");
+		arena_final(&t_json->arena);
+		vector_final(&cursor.frames);
+		vector_final(&cursor.values);
+		return 0;
+	}
+	
+	t_json->source.data = t_data;
+	t_json->source.size = t_size;
+	t_json->source.is_mapped = 0;
+	t_json->source.is_allocated = 0;
+	
+	cursor.c = (const unsigned char*)t_data;
+	cursor.end = cursor.c + t_size;
+	cursor.max_depth = t_options->max_depth;
+	cursor.exact_integers = t_options->exact_integers;
+	cursor.validate_utf8 = t_options->validate_utf8;
+	
+	json_value root;
+	
+	int result = json_read_cbor_value(&cursor, t_json, &root) && root.type == json_data_type_object && cursor.c == cursor.end;
+	
+	vector_final(&cursor.frames);
+	vector_final(&cursor.values);
+	
+	if (!result)
+	{
+		JSON_LOG("failed to read root map");
+		json_key_table_final(&t_json->keys);
+		arena_final(&t_json->arena);
+		return 0;
+	}
+	
+	t_json->root = root.value.blob->object;
+	
+	JSON_LOG("succeeded load cbor from buffer");
+	
+	return 1;
+}
+
+int json_load_cbor_from_buffer(json_file* t_json, const char* t_data, size_t t_size)
+{
+	json_load_options options;
+	json_load_options_init(&options);
+	
+	return json_load_cbor_from_buffer_with_options(t_json, t_data, t_size, &options);
+}
+
+int json_load_cbor(json_file* t_json, const char* t_path)
+{
+	assert(t_json && t_path);
+	
+	JSON_LOG("begin load cbor");
+	
+	json_load_options options;
+	json_load_options_init(&options);
+	
+	json_mapping mapping;
+	if (!json_mapping_init(&mapping, t_path))
+	{
+		JSON_LOG("failed to map file");
+		return 0;
+	}
+	
+	if (!json_load_cbor_from_buffer_with_options(t_json, mapping.data, mapping.size, &options))
+	{
+		json_mapping_final(&mapping);
+		return 0;
+	}
+	
+	t_json->source = mapping;
+	
+	JSON_LOG("succeeded load cbor");
+	
+	return 1;
+}
+
+unsigned int json_schema_hash(unsigned int t_seed, const char* t_key, size_t t_length)
+{
+	unsigned int hash = t_seed ^ 2166136261u;
+	const char* end = t_key + t_length;
+	
+	for (; t_key != end; ++t_key)
+	{
+		hash = (hash ^ (unsigned char)*t_key) * 16777619u;
+	}
+	return hash ^ (hash >> 15);
+}
+
+size_t json_schema_element_size(const json_field* t_field)
+{
+	switch (t_field->element_type)
+	{
+	case json_field_type_boolean:
+		return sizeof(json_boolean);
+	case json_field_type_integer:
+		return sizeof(json_integer);
+	case json_field_type_number:
+		return sizeof(json_number);
+	case json_field_type_string:
+		return sizeof(json_string);
+	case json_field_type_object:
+		return t_field->schema ? t_field->schema->size : 0;
+	default:
+		return 0;
+	}
+}
+
+int json_schema_init(json_schema* t_schema, const json_field* t_fields, unsigned int t_field_count, size_t t_size)
+{
+	assert(t_schema && (t_fields || !t_field_count));
+	
+	JSON_LOG("begin schema init");
+	
+	t_schema->fields = t_fields;
+	t_schema->field_count = t_field_count;
+	t_schema->size = t_size;
+	t_schema->seed = 0;
+	t_schema->table = 0;
+	t_schema->name_lengths = (size_t*)malloc((t_field_count ? t_field_count : 1) * sizeof(size_t));
+	
+	if (t_field_count >= 0xffff || !t_schema->name_lengths)
+	{
+		JSON_LOG("failed to allocate schema");
+		json_schema_final(t_schema);
+		return 0;
+	}
+	
+	unsigned int i = 0;
+	for (; i < t_field_count; ++i)
+	{
+		const json_field* field = t_fields + i;
+		t_schema->name_lengths[i] = strlen(field->name);
+		
+		if ((field->type == json_field_type_object && !field->schema)
+			|| (field->type == json_field_type_array && !json_schema_element_size(field))
+			|| field->type < json_field_type_boolean || field->type > json_field_type_array)
+		{
+			JSON_LOG("field \"%s\" is malformed", field->name);
+			json_schema_final(t_schema);
+			return 0;
+		}
+	}
+	
+	/* look for a seed that sends every name to its own slot, widening the table when none is found */
+	
+	unsigned int size = 4;
+	while (size < t_field_count * 2)
+	{
+		size *= 2;
+	}
+	
+	for (; size <= 0x100000; size *= 2)
+	{
+		unsigned short* table = (unsigned short*)realloc(t_schema->table, size * sizeof(unsigned short));
+		if (!table)
+		{
+			JSON_LOG("failed to allocate schema table");
+			json_schema_final(t_schema);
+			return 0;
+		}
+		t_schema->table = table;
+		t_schema->mask = size - 1;
+		
+		unsigned int seed = 0;
+		for (; seed < 256; ++seed)
+		{
+			memset(table, 0, size * sizeof(unsigned short));
+			for (i = 0; i < t_field_count; ++i)
+			{
+				unsigned short* slot = table + (json_schema_hash(seed, t_fields[i].name, t_schema->name_lengths[i]) & t_schema->mask);
+				if (*slot)
+				{
+					break;
+				}
+				*slot = (unsigned short)(i + 1);
+			}
+			if (i == t_field_count)
+			{
+				t_schema->seed = seed;
+				JSON_LOG("succeeded schema init");
+				return 1;
+			}
+		}
+	}
+	
+	JSON_LOG("failed to find a perfect hash, field names may repeat");
+	json_schema_final(t_schema);
+	return 0;
+}
+
+void json_schema_final(json_schema* t_schema)
+{
+	assert(t_schema);
+	
+	free(t_schema->table);
+	free(t_schema->name_lengths);
+	t_schema->table = 0;
+	t_schema->name_lengths = 0;
+}
+
+const json_field* json_schema_find(const json_schema* t_schema, const char* t_key, size_t t_length)
+{
+	unsigned int index = t_schema->table[json_schema_hash(t_schema->seed, t_key, t_length) & t_schema->mask];
+	
+	if (!index || t_schema->name_lengths[index - 1] != t_length || memcmp(t_schema->fields[index - 1].name, t_key, t_length))
+	{
+		return 0;
+	}
+	return t_schema->fields + index - 1;
+}
+
+int json_schema_skip(p_json_cursor t_cursor)
+{
+	/* steps over a value nobody asked for, strings hold no structurals besides their quotes so brackets are simply counted */
+	
+	const char* c = json_next(t_cursor);
+	unsigned int depth = 0;
+	
+	if (!c)
+	{
+		return 0;
+	}
+	if (*c == '"')
+	{
+		return json_next(t_cursor) != 0;
+	}
+	
+	for (;;)
+	{
+		if (*c == '{' || *c == '[')
+		{
+			++depth;
+		}
+		else if (*c == '}' || *c == ']')
+		{
+			if (!depth)
+			{
+				JSON_LOG("unexpected close bracket");
+				return 0;
+			}
+			--depth;
+		}
+		if (!depth)
+		{
+			return 1;
+		}
+		c = json_next(t_cursor);
+		if (!c)
+		{
+			JSON_LOG("unexpected end of text");
+			return 0;
+		}
+	}
+}
+
+int json_schema_decode_object(p_json_cursor t_cursor, const json_schema* t_schema, char* t_out, p_arena t_arena, unsigned int t_depth);
+
+int json_schema_decode_field(p_json_cursor t_cursor, const json_field* t_field, unsigned int t_type, char* t_out, p_arena t_arena, unsigned int t_depth)
+{
+	const char* c = json_peek(t_cursor);
+	json_value value;
+	
+	if (!c)
+	{
+		JSON_LOG("unexpected end of text");
+		return 0;
+	}
+	
+	switch (t_type)
+	{
+	case json_field_type_boolean:
+	{
+		if (*c != 't' && *c != 'f')
+		{
+			break;
+		}
+		json_next(t_cursor);
+		if (json_read_literal(t_cursor, c, "true") || json_read_literal(t_cursor, c, "false"))
+		{
+			*(json_boolean*)t_out = *c == 't';
+			return 1;
+		}
+		break;
+	}
+	case json_field_type_integer:
+	case json_field_type_number:
+	{
+		if (*c != '-' && !is_digit(*c))
+		{
+			break;
+		}
+		json_next(t_cursor);
+		if (!json_read_number(t_cursor, c, &value))
+		{
+			return 0;
+		}
+		if (t_type == json_field_type_number)
+		{
+			*(json_number*)t_out = value.type == json_data_type_integer ? (json_number)value.value.integer : value.value.number;
+			return 1;
+		}
+		if (value.type == json_data_type_integer)
+		{
+			*(json_integer*)t_out = value.value.integer;
+			return 1;
+		}
+		if (value.value.number == floor(value.value.number) && fabs(value.value.number) <= 9007199254740992.0)
+		{
+			*(json_integer*)t_out = (json_integer)value.value.number;
+			return 1;
+		}
+		JSON_LOG("field \"%s\" expects an integer", t_field->name);
 		return 0;
 	}
-	
-	if (s[0] == '{')
+	case json_field_type_string:
+	{
+		if (*c != '"')
+		{
+			break;
+		}
+		return json_read_string(t_cursor, t_arena, (json_string*)t_out);
+	}
+	case json_field_type_object:
+	{
+		if (*c != '{')
+		{
+			break;
+		}
+		return json_schema_decode_object(t_cursor, t_field->schema, t_out, t_arena, t_depth + 1);
+	}
+	case json_field_type_array:
 	{
-		/* object */
-		
-		JSON_LOG("value is object");
-		
-		t_out_value->type = json_data_type_object;
-		t_out_value->value.blob = factory_alloc(&t_json->blob_factory);
-		
-		if (!t_out_value->value.blob)
+		if (*c != '[')
 		{
-			JSON_LOG("failed to acquire blob");
+			break;
+		}
+		if (t_depth >= t_cursor->max_depth)
+		{
+			JSON_LOG("maximum depth exceeded");
 			return 0;
 		}
+		json_next(t_cursor);
 		
-		json_object* object = &t_out_value->value.blob->object;
+		/* elements gather in a scratch vector and move to the arena once their count is known */
 		
-		if (!hash_list_init((p_hash_list)object))
+		size_t element_size = json_schema_element_size(t_field);
+		json_field_array* array = (json_field_array*)t_out;
+		vector elements;
+		if (!vector_init(&elements, (unsigned int)element_size))
 		{
-			JSON_LOG("failed to initialize object");
 			return 0;
 		}
 		
-		int is_expecting_separator = 0;
+		c = json_peek(t_cursor);
+		if (c && *c == ']')
+		{
+			json_next(t_cursor);
+			array->data = 0;
+			array->count = 0;
+			vector_final(&elements);
+			return 1;
+		}
 		
-		do
+		for (;;)
 		{
-			json_skip_whitespace(t_file);
-			if (!fread(s, 1, 1, t_file))
+			if (!vector_grow(&elements, elements.element_count + 1))
 			{
-				JSON_LOG("failed to read first character of property");
+				vector_final(&elements);
 				return 0;
 			}
 			
-			if (s[0] == '"')
-			{
-				/* property name */
-				
-				if (fseek(t_file, -1, SEEK_CUR))
-				{
-					JSON_LOG("failed to seek for property name");
-					goto json_read_value_object_fail;
-				}
-				
-				if (is_expecting_separator)
-				{
-					JSON_LOG("unexpected string");
-					goto json_read_value_object_fail;
-				}
-				
-				buffer name;
-				
-				if (!json_read_string(t_file, &name))
-				{
-					JSON_LOG("failed to read property name");
-					goto json_read_value_object_fail;
-				}
-				
-				JSON_LOG("property \"%s\" : ", (char*)name.data);
-				if (!json_skip_whitespace(t_file) || !fread(s, 1, 1, t_file) || s[0] != ':')
-				{
-					JSON_LOG("failed to read colon");
-					buffer_final(&name);
-					goto json_read_value_object_fail;
-				}
-				
-				json_value* value = factory_alloc(&t_json->value_factory);
-				
-				if (!value)
-				{
-					JSON_LOG("failed to acquire value from factory");
-					buffer_final(&name);
-					goto json_read_value_object_fail;
-				}
-				
-				/* I hate recursion, but I want this working, I can unwind this from recursion later */
-				
-				if (!json_skip_whitespace(t_file) || !json_read_value(t_file, t_json, value))
-				{
-					JSON_LOG("failed to read value");
-					factory_free(&t_json->value_factory, value);
-					buffer_final(&name);
-					goto json_read_value_object_fail;
-				}
-				
-				if (!hash_list_insert((p_hash_list)object, (char*)name.data, value))
-				{
-					JSON_LOG("failed to insert property");
-					factory_free(&t_json->value_factory, value);
-					buffer_final(&name);
-					goto json_read_value_object_fail;
-				}
-				
-				is_expecting_separator = 1;
-			}
-			else if (s[0] == ',')
+			char* element = (char*)elements.buffer.data + elements.element_count * element_size;
+			memset(element, 0, element_size);
+			++elements.element_count;
+			
+			if (!json_schema_decode_field(t_cursor, t_field, t_field->element_type, element, t_arena, t_depth + 1))
 			{
-				/* property separator */
-				
-				if (!is_expecting_separator)
-				{
-					JSON_LOG("unexpected separator");
-					goto json_read_value_object_fail;
-				}
-				is_expecting_separator = 0;
+				vector_final(&elements);
+				return 0;
 			}
-			else if (s[0] == '}')
+			
+			c = json_next(t_cursor);
+			if (c && *c == ',')
 			{
-				/* end of object */
+				continue;
 			}
-			else
+			if (c && *c == ']')
 			{
-				/* unexpected result, fail out */
-				
-				JSON_LOG("character is unexpected, fail out");
-				
-json_read_value_object_fail:
-
-				factory_free(&t_json->blob_factory, t_out_value->value.blob);
-				t_out_value->type = json_data_type_undefined;
-				t_out_value->value.blob = 0;
-				return 0;
+				break;
 			}
+			JSON_LOG("expected comma or close bracket");
+			vector_final(&elements);
+			return 0;
+		}
 		
+		array->data = arena_alloc(t_arena, elements.element_count * element_size);
+		array->count = elements.element_count;
+		if (array->data)
+		{
+			memcpy(array->data, elements.buffer.data, elements.element_count * element_size);
 		}
-		while (s[0] != '}');
+		vector_final(&elements);
+		return array->data != 0;
+	}
 	}
-	else if (s[0] == '[')
+	
+	/* null leaves the member untouched */
+	
+	if (*c == 'n')
 	{
-		/* array */
-		
-		JSON_LOG("value is array");
-		
-		t_out_value->type = json_data_type_array;
-		t_out_value->value.blob = factory_alloc(&t_json->blob_factory);
+		json_next(t_cursor);
+		if (json_read_literal(t_cursor, c, "null"))
+		{
+			return 1;
+		}
+	}
+	
+	JSON_LOG("field \"%s\" has the wrong type", t_field->name);
+	return 0;
+}
+
+int json_schema_decode_object(p_json_cursor t_cursor, const json_schema* t_schema, char* t_out, p_arena t_arena, unsigned int t_depth)
+{
+	if (t_depth >= t_cursor->max_depth)
+	{
+		JSON_LOG("maximum depth exceeded");
+		return 0;
+	}
+	
+	const char* c = json_next(t_cursor);
+	if (!c || *c != '{')
+	{
+		JSON_LOG("expected object");
+		return 0;
+	}
+	
+	c = json_peek(t_cursor);
+	if (c && *c == '}')
+	{
+		json_next(t_cursor);
+		return 1;
+	}
+	
+	for (;;)
+	{
+		json_string name;
 		
-		if (!t_out_value->value.blob)
+		if (!json_read_string(t_cursor, t_arena, &name))
+		{
+			JSON_LOG("failed to read property name");
+			return 0;
+		}
+		c = json_next(t_cursor);
+		if (!c || *c != ':')
 		{
-			JSON_LOG("failed to acquire blob");
+			JSON_LOG("failed to read colon");
 			return 0;
 		}
 		
-		json_array* array = &t_out_value->value.blob->array;
-		if (!vector_init((p_vector)array, sizeof(json_value)))
+		const json_field* field = json_schema_find(t_schema, (const char*)name.data, name.size);
+		if (field ? !json_schema_decode_field(t_cursor, field, field->type, t_out + field->offset, t_arena, t_depth) : !json_schema_skip(t_cursor))
 		{
-			JSON_LOG("failed to initialize array");
-			factory_free(&t_json->blob_factory, t_out_value->value.blob);
-			t_out_value->type = json_data_type_undefined;
-			t_out_value->value.blob = 0;
 			return 0;
 		}
 		
-		int is_expecting_separator = 0;
+		c = json_next(t_cursor);
+		if (c && *c == ',')
+		{
+			continue;
+		}
+		if (c && *c == '}')
+		{
+			return 1;
+		}
+		JSON_LOG("expected comma or close brace");
+		return 0;
+	}
+}
+
+int json_schema_decode(const json_schema* t_schema, const char* t_data, size_t t_size, void* t_out_struct, arena* t_arena)
+{
+	assert(t_schema && (t_data || !t_size) && t_out_struct && t_arena);
+	
+	JSON_LOG("begin schema decode");
+	
+	vector structurals;
+	if (!json_scan(t_data, t_size, &structurals))
+	{
+		JSON_LOG("failed to scan structure");
+		return 0;
+	}
+	
+	json_cursor cursor;
+	cursor.data = t_data;
+	cursor.end = t_data + t_size;
+	cursor.structural = (const unsigned int*)structurals.buffer.data;
+	cursor.structural_end = cursor.structural + structurals.element_count;
+	cursor.prebuilt = 0;
+	cursor.max_depth = JSON_MAX_DEPTH;
+	cursor.exact_integers = 1;
+	cursor.validate_utf8 = 0;
+	
+	int result = json_schema_decode_object(&cursor, t_schema, (char*)t_out_struct, t_arena, 0) && cursor.structural == cursor.structural_end;
+	
+	vector_final(&structurals);
+	
+	if (!result)
+	{
+		JSON_LOG("failed schema decode");
+		return 0;
+	}
+	
+	JSON_LOG("succeeded schema decode");
+	
+	return 1;
+}
+
+int json_schema_write_field(p_json_writer t_writer, const json_field* t_field, unsigned int t_type, const char* t_member, unsigned int t_depth)
+{
+	char s[32];
+	
+	switch (t_type)
+	{
+	case json_field_type_boolean:
+		return *(const json_boolean*)t_member ? json_writer_append(t_writer, "true", 4) : json_writer_append(t_writer, "false", 5);
+	case json_field_type_integer:
+	{
+		json_integer integer = *(const json_integer*)t_member;
+		unsigned long long int magnitude = (unsigned long long int)integer;
+		unsigned int length = 0;
+		if (integer < 0)
+		{
+			s[length++] = '-';
+			magnitude = 0 - magnitude;
+		}
+		length += json_format_integer(magnitude, s + length);
+		return json_writer_append(t_writer, s, length);
+	}
+	case json_field_type_number:
+		return json_writer_append(t_writer, s, json_format_number(*(const json_number*)t_member, s));
+	case json_field_type_string:
+	{
+		const json_string* string = (const json_string*)t_member;
+		return string->data ? json_write_string(t_writer, (const char*)string->data, string->size) : json_writer_append(t_writer, "null", 4);
+	}
+	case json_field_type_object:
+	{
+		const json_schema* schema = t_field->schema;
+		const int is_pretty = !t_writer->options.is_compact;
+		unsigned int i = 0;
 		
-		do
+		if (!json_writer_append(t_writer, "{", 1))
 		{
-			json_skip_whitespace(t_file);
-			if (!fread(s, 1, 1, t_file))
-			{
-				JSON_LOG("failed to read first character of entry");
-				return 0;
-			}
+			return 0;
+		}
+		for (; i < schema->field_count; ++i)
+		{
+			const json_field* field = schema->fields + i;
 			
-			if (s[0] == ',')
+			if ((i && !json_writer_append(t_writer, ",", 1)) || (is_pretty && !json_write_line(t_writer, t_depth + 1)))
 			{
-				/* property separator */
-				
-				if (!is_expecting_separator)
-				{
-					JSON_LOG("unexpected separator");
-					goto json_read_value_array_fail;
-				}
-				is_expecting_separator = 0;
+				return 0;
 			}
-			else if (s[0] == ']')
+			if (!json_write_string(t_writer, field->name, schema->name_lengths[i]) || !(is_pretty ? json_writer_append(t_writer, " : ", 3) : json_writer_append(t_writer, ":", 1)))
 			{
-				/* end of array */
+				return 0;
 			}
-			else
+			if (!json_schema_write_field(t_writer, field, field->type, t_member + field->offset, t_depth + 1))
 			{
-				/* property value */
-				
-				if (fseek(t_file, -1, SEEK_CUR))
-				{
-					JSON_LOG("failed to seek for array value");
-					goto json_read_value_array_fail;
-				}
-				
-				if (is_expecting_separator || !json_skip_whitespace(t_file))
-				{
-					JSON_LOG("unexpected value");
-					goto json_read_value_array_fail;
-				}
-				
-				json_value value;
-				
-				/* I hate recursion, but I want this working, I can unwind this from recursion later */
-				
-				if (!json_read_value(t_file, t_json, &value) || !vector_push((p_vector)array, &value))
-				{
-					JSON_LOG("failed to read and push value");
-					
-json_read_value_array_fail:
-				
-					vector_final(array);
-					factory_free(&t_json->blob_factory, t_out_value->value.blob);
-					t_out_value->type = json_data_type_undefined;
-					t_out_value->value.blob = 0;
-					return 0;
-				}
-				
-				is_expecting_separator = 1;
+				return 0;
 			}
 		}
-		while (s[0] != ']');
+		return (!is_pretty || json_write_line(t_writer, t_depth)) && json_writer_append(t_writer, "}", 1);
 	}
-	else if (s[0] == '"')
+	case json_field_type_array:
 	{
-		/* string */
-		
-		JSON_LOG("value is string");
-		
-		t_out_value->type = json_data_type_string;
-		t_out_value->value.blob = factory_alloc(&t_json->blob_factory);
+		const json_field_array* array = (const json_field_array*)t_member;
+		const int is_pretty = !t_writer->options.is_compact;
+		size_t element_size = json_schema_element_size(t_field);
+		unsigned int i = 0;
 		
-		if (!t_out_value->value.blob)
+		if (!json_writer_append(t_writer, "[", 1))
 		{
-			JSON_LOG("failed to acquire blob");
 			return 0;
 		}
-		
-		if (fseek(t_file, -1, SEEK_CUR) || !json_read_string(t_file, (p_buffer)&t_out_value->value.blob->string))
+		for (; i < array->count; ++i)
 		{
-			JSON_LOG("failed to seek and read string");
-			
-			factory_free(&t_json->blob_factory, t_out_value->value.blob);
-			t_out_value->type = json_data_type_undefined;
-			t_out_value->value.blob = 0;
-			return 0;
+			if ((i && !json_writer_append(t_writer, ",", 1)) || (is_pretty && !json_write_line(t_writer, t_depth + 1)))
+			{
+				return 0;
+			}
+			if (!json_schema_write_field(t_writer, t_field, t_field->element_type, (const char*)array->data + i * element_size, t_depth + 1))
+			{
+				return 0;
+			}
 		}
+		return (!is_pretty || json_write_line(t_writer, t_depth)) && json_writer_append(t_writer, "]", 1);
 	}
-	else if (s[0] == '-' || (s[0] >= '0' && s[0] <= '9'))
+	default:
+		return 0;
+	}
+}
+
+int json_schema_write(json_writer* t_writer, const json_schema* t_schema, const void* t_struct)
+{
+	assert(t_writer && t_schema && t_struct);
+	
+	/* the root is written as an object field of the schema */
+	
+	json_field root;
+	memset(&root, 0, sizeof(root));
+	root.type = json_field_type_object;
+	root.schema = t_schema;
+	
+	if (!json_schema_write_field(t_writer, &root, json_field_type_object, (const char*)t_struct, 0))
 	{
-		/* number */
+		JSON_LOG("failed to write struct");
+		return 0;
+	}
+	return 1;
+}
+
+#define json_snapshot_version 1
+#define json_snapshot_byte_order 0x01020304
+
+/* snapshot images are built of fixed size nodes and entries found by offset from the start of the image, every block aligned to eight bytes */
+
+typedef struct
+{
+	unsigned int type;
+	unsigned int count;
+	union
+	{
+		json_boolean boolean;
+		json_number number;
+		json_integer integer;
+		unsigned long long int offset;
+	} value;
+} json_snapshot_node;
+
+typedef struct
+{
+	unsigned long long int key_offset;
+	unsigned long long int key_length;
+	json_snapshot_node value;
+} json_snapshot_entry;
+
+typedef struct
+{
+	char magic[8];
+	unsigned int byte_order;
+	unsigned int version;
+	unsigned int node_size;
+	unsigned int entry_size;
+	unsigned long long int image_size;
+	unsigned long long int source_size;
+	unsigned long long int source_time;
+	json_snapshot_node root;
+} json_snapshot_header;
+
+typedef struct
+{
+	const char* key;
+	size_t key_length;
+	unsigned int index;
+} json_snapshot_key;
+
+int json_file_status(const char* t_path, unsigned long long int* t_out_size, unsigned long long int* t_out_time)
+{
+	assert(t_path && t_out_size && t_out_time);
+
+#if defined(_WIN32)
+	
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(t_path, GetFileExInfoStandard, &attributes))
+	{
+		JSON_LOG("failed to find file status");
+		return 0;
+	}
+	
+	*t_out_size = ((unsigned long long int)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+	*t_out_time = ((unsigned long long int)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+	return 1;
+
+#elif defined(__linux__)
+	
+	struct stat status;
+	if (stat(t_path, &status))
+	{
+		JSON_LOG("failed to find file status");
+		return 0;
+	}
+	
+	*t_out_size = (unsigned long long int)status.st_size;
+	*t_out_time = (unsigned long long int)status.st_mtim.tv_sec * 1000000000ULL + (unsigned long long int)status.st_mtim.tv_nsec;
+	return 1;
+
+#else
+	
+	JSON_LOG("file status is not supported on this platform");
+	return 0;
+
+#endif
+}
+
+int json_snapshot_reserve(p_json_writer t_writer, size_t t_size, size_t* t_out_offset)
+{
+	/* appends zeroed space, aligned to eight bytes, for a block that is filled in later */
+	
+	size_t padding = (8 - (t_writer->size & 7)) & 7;
+	
+	if (!json_writer_grow(t_writer, padding + t_size))
+	{
+		return 0;
+	}
+	
+	memset(t_writer->data + t_writer->size, 0, padding + t_size);
+	*t_out_offset = t_writer->size + padding;
+	t_writer->size += padding + t_size;
+	return 1;
+}
+
+int json_snapshot_compare_keys(const void* t_a, const void* t_b)
+{
+	const json_snapshot_key* a = (const json_snapshot_key*)t_a;
+	const json_snapshot_key* b = (const json_snapshot_key*)t_b;
+	int result = memcmp(a->key, b->key, a->key_length < b->key_length ? a->key_length : b->key_length);
+	
+	return result ? result : (a->key_length > b->key_length) - (a->key_length < b->key_length);
+}
+
+int json_snapshot_write_value(p_json_writer t_writer, const json_value* t_value, size_t t_node_offset)
+{
+	json_snapshot_node node;
+	memset(&node, 0, sizeof(node));
+	node.type = t_value->type;
+	
+	switch (t_value->type)
+	{
+	case json_data_type_object:
+	{
+		/* entries in property order followed by their indices in key order */
 		
-		JSON_LOG("value is number");
+		const json_object* object = &t_value->value.blob->object;
+		
+		node.count = object->properties.element_count;
+		if (!node.count)
+		{
+			break;
+		}
 		
-		char* c = s;
-		int has_exponent_been_used = 0;
-		int has_decimal_been_used = 0;
-		int has_minus_been_used = 1;
-		int skip_check = 1;
+		size_t offset = 0;
+		json_snapshot_key* keys = (json_snapshot_key*)malloc(node.count * sizeof(json_snapshot_key));
+		if (!keys || !json_snapshot_reserve(t_writer, node.count * (sizeof(json_snapshot_entry) + sizeof(unsigned int)), &offset))
+		{
+			JSON_LOG("failed to allocate object entries");
+			free(keys);
+			return 0;
+		}
+		node.value.offset = offset;
 		
-		while (skip_check || ((*c) >= '0' && (*c) <= '9' && c - s < 64))
+		unsigned int i = 0;
+		for (; i < node.count; ++i)
 		{
-			++c;
-			skip_check = 0;
-			if (!fread(c, 1, 1, t_file))
+			const json_property* property = (const json_property*)object->properties.buffer.data + i;
+			size_t entry_offset = offset + i * sizeof(json_snapshot_entry);
+			json_snapshot_entry entry;
+			size_t key_offset = 0;
+			
+			if (!json_snapshot_reserve(t_writer, property->key_length, &key_offset))
 			{
-				JSON_LOG("failed to reach number character");
+				free(keys);
 				return 0;
 			}
-			if ((*c) == '-')
-			{
-				if (has_minus_been_used)
-				{
-					JSON_LOG("unexpected minus");
-					/* minus in wrong place, fail out */
-					return 0;
-				}
-				has_decimal_been_used = 1;
-				skip_check = 1;
-			}
-			else if ((*c) == '.')
-			{
-				if (has_decimal_been_used)
-				{
-					JSON_LOG("unexpected decimal");
-					/* too many decimals, fail out */
-					return 0;
-				}
-				has_decimal_been_used = 1;
-				has_minus_been_used = 1;
-				skip_check = 1;
-			}
-			else if ((*c) == 'e' || (*c) == 'E')
-			{
-				if (has_exponent_been_used)
-				{
-					JSON_LOG("unexpected exponent");
-					/* too many exponents, fail out */
-					return 0;
-				}
-				has_exponent_been_used = 1;
-				has_decimal_been_used = 0;
-				has_minus_been_used = 0;
-				skip_check = 1;
-			}
-			else
+			memcpy(t_writer->data + key_offset, property->key, property->key_length);
+			
+			memset(&entry, 0, sizeof(entry));
+			entry.key_offset = key_offset;
+			entry.key_length = property->key_length;
+			memcpy(t_writer->data + entry_offset, &entry, sizeof(entry));
+			
+			if (!json_snapshot_write_value(t_writer, &property->value, entry_offset + offsetof(json_snapshot_entry, value)))
 			{
-				has_minus_been_used = 1;
+				free(keys);
+				return 0;
 			}
-		};
+			
+			keys[i].key = property->key;
+			keys[i].key_length = property->key_length;
+			keys[i].index = i;
+		}
+		
+		qsort(keys, node.count, sizeof(json_snapshot_key), json_snapshot_compare_keys);
 		
-		*c = '\0';
-		if (fseek(t_file, -1, SEEK_CUR))
+		unsigned int* index = (unsigned int*)(t_writer->data + offset + node.count * sizeof(json_snapshot_entry));
+		for (i = 0; i < node.count; ++i)
 		{
-			JSON_LOG("failed to seek to reset end of number");
-			return 0;
+			index[i] = keys[i].index;
 		}
-		t_out_value->type = json_data_type_number;
-		t_out_value->value.number = strtod(s, 0);
+		free(keys);
+		break;
 	}
-	else if (s[0] == 't' || s[0] == 'f')
+	case json_data_type_array:
 	{
-		/* boolean */
-		
-		JSON_LOG("value is boolean");
+		const json_array* array = &t_value->value.blob->array;
+		node.count = array->element_count;
+		if (!node.count)
+		{
+			break;
+		}
 		
-		if (s[0] == 't')
+		size_t offset = 0;
+		if (!json_snapshot_reserve(t_writer, node.count * sizeof(json_snapshot_node), &offset))
 		{
-			if (fread(s + 1, 1, 3, t_file) != 3)
-			{
-				JSON_LOG("failed to read true");
-				return 0;
-			}
-			s[4] = '\0';
-			if (strcmp(s, "true"))
-			{
-				JSON_LOG("unknown result, expected true");
-				return 0;
-			}
-			t_out_value->type = json_data_type_boolean;
-			t_out_value->value.boolean = 1;
+			JSON_LOG("failed to allocate array entries");
+			return 0;
 		}
-		else if (s[0] == 'f')
+		node.value.offset = offset;
+		
+		unsigned int i = 0;
+		for (; i < node.count; ++i)
 		{
-			if (fread(s + 1, 1, 4, t_file) != 4)
-			{
-				JSON_LOG("failed to read false");
-				return 0;
-			}
-			s[5] = '\0';
-			if (strcmp(s, "false"))
+			if (!json_snapshot_write_value(t_writer, (const json_value*)array->buffer.data + i, offset + i * sizeof(json_snapshot_node)))
 			{
-				JSON_LOG("unknown result, expected false");
 				return 0;
 			}
-			t_out_value->type = json_data_type_boolean;
-			t_out_value->value.boolean = 0;
 		}
+		break;
 	}
-	else if (s[0] == 'n')
+	case json_data_type_string:
 	{
-		/* null */
-		
-		JSON_LOG("value is null");
-		
-		if (fread(s + 1, 1, 3, t_file) != 3)
+		const json_string* string = &t_value->value.blob->string;
+		if (string->size > 0xffffffff)
 		{
-			JSON_LOG("failed to read null");
+			JSON_LOG("string too long for a snapshot");
 			return 0;
 		}
-		s[4] = '\0';
-		if (strcmp(s, "null"))
+		
+		size_t offset = 0;
+		if (!json_snapshot_reserve(t_writer, string->size, &offset))
 		{
-			JSON_LOG("unknown result, expected null");
 			return 0;
 		}
-		t_out_value->type = json_data_type_null;
-		t_out_value->value.null = 0;
+		memcpy(t_writer->data + offset, string->data, string->size);
+		node.count = (unsigned int)string->size;
+		node.value.offset = offset;
+		break;
 	}
-	else
-	{
-		/* unknown */
-		
-		JSON_LOG("value is unexpected, fail out");
-		
-		return 0;
+	case json_data_type_boolean:
+		node.value.boolean = t_value->value.boolean;
+		break;
+	case json_data_type_number:
+		node.value.number = t_value->value.number;
+		break;
+	case json_data_type_integer:
+		node.value.integer = t_value->value.integer;
+		break;
+	default:
+		node.type = json_data_type_null;
+		break;
 	}
 	
-	JSON_LOG("succeed read value");
-	
+	memcpy(t_writer->data + t_node_offset, &node, sizeof(node));
 	return 1;
 }
 
-int json_load(json_file* t_json, const char* t_string)
+int json_snapshot_save(const json_file* t_json, const char* t_source_path, const char* t_path)
 {
-	assert(t_json && t_string);
+	assert(t_json && t_source_path && t_path);
 	
-	JSON_LOG("begin load");
+	JSON_LOG("begin save snapshot");
 	
-	FILE* file = fopen(t_string, "rb");
-	if (!file)
+	json_snapshot_header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "JSONSNAP", sizeof(header.magic));
+	header.byte_order = json_snapshot_byte_order;
+	header.version = json_snapshot_version;
+	header.node_size = sizeof(json_snapshot_node);
+	header.entry_size = sizeof(json_snapshot_entry);
+	
+	if (!json_file_status(t_source_path, &header.source_size, &header.source_time))
 	{
-		JSON_LOG("failed to open file");
 		return 0;
 	}
 	
-	fseek(file, 0, SEEK_END);
-	long int file_length = ftell(file);
-	(void)file_length;
-
-	fseek(file, 0, SEEK_SET);
+	json_value root;
+	root.type = json_data_type_object;
+	root.value.blob = (p_json_blob)&t_json->root;
 	
-	if (!factory_init(&t_json->blob_factory, sizeof(json_blob), 32))
+	json_writer writer;
+	size_t offset = 0;
+	if (!json_writer_init(&writer, sizeof(header) + json_estimate_size(&root)))
 	{
-		JSON_LOG("failed to init blob factory");
-		fclose(file);
+		JSON_LOG("failed to initialize writer");
 		return 0;
 	}
-	if (!factory_init(&t_json->value_factory, sizeof(json_value), 256))
+	if (!json_snapshot_reserve(&writer, sizeof(header), &offset) || !json_snapshot_write_value(&writer, &root, offsetof(json_snapshot_header, root)))
 	{
-		JSON_LOG("failed to init value factory");
-		factory_final(&t_json->blob_factory);
-		fclose(file);
+		JSON_LOG("failed to build snapshot");
+		json_writer_final(&writer);
 		return 0;
 	}
 	
-	json_value root;
+	/* the image size is checked on open, so a partly written image is never used */
 	
-	if (!json_read_value(file, t_json, &root) || root.type != json_data_type_object)
+	header.image_size = writer.size;
+	memcpy(&header.root, writer.data + offsetof(json_snapshot_header, root), sizeof(header.root));
+	memcpy(writer.data, &header, sizeof(header));
+	
+	FILE* file = fopen(t_path, "wb");
+	int result = file && fwrite(writer.data, 1, writer.size, file) == writer.size;
+	if (file && fclose(file))
 	{
-		JSON_LOG("failed to read root object");
-		factory_final(&t_json->blob_factory);
-		factory_final(&t_json->value_factory);
-		fclose(file);
-		return 0;
+		result = 0;
 	}
+	json_writer_final(&writer);
 	
-	t_json->root = root.value.blob->object;
-	
-	fclose(file);
+	if (!result)
+	{
+		JSON_LOG("failed to write snapshot");
+		return 0;
+	}
 	
-	JSON_LOG("succeeded load");
+	JSON_LOG("succeeded save snapshot");
 	
 	return 1;
 }
 
-void json_final(json_file* t_json)
+int json_snapshot_open(json_snapshot* t_snapshot, const char* t_path, const char* t_source_path)
 {
-	assert(t_json);
+	assert(t_snapshot && t_path);
 	
-	factory_final(&t_json->blob_factory);
-	factory_final(&t_json->value_factory);
-}
-
-#if !JSON_DEBUG_LOG_STRINGIFY
-#undef JSON_LOG
-#define JSON_LOG(...) JSON_NOP
-#else
-#undef JSON_LOG
-#define JSON_LOG(...) JSON_LOG_DEFINITION(__VA_ARGS__)
-#endif
-
-int json_push_string(p_vector t_vector, const char* t_string, int t_should_expand_escape_characters)
-{
-	const char* c = t_string;
+	JSON_LOG("begin open snapshot");
 	
-	for (; *c != '\0'; ++c)
+	if (!json_mapping_init(&t_snapshot->image, t_path))
 	{
-		if (t_should_expand_escape_characters)
-		{
-			if (*c == '\"')
-			{
-				if (!vector_push(t_vector, "\\") || !vector_push(t_vector, "\""))
-				{
-					return 0;
-				}
-				continue;
-			}
-			else if (*c == '\\')
-			{
-				if (!vector_push(t_vector, "\\") || !vector_push(t_vector, "\\"))
-				{
-					return 0;
-				}
-				continue;
-			}
-			else if (*c == '\b')
-			{
-				if (!vector_push(t_vector, "\\") || !vector_push(t_vector, "b"))
-				{
-					return 0;
-				}
-				continue;
-			}
-			else if (*c == '\f')
-			{
-				if (!vector_push(t_vector, "\\") || !vector_push(t_vector, "f"))
-				{
-					return 0;
-				}
-				continue;
-			}
-			else if (*c == '\n')
-			{
-				if (!vector_push(t_vector, "\\") || !vector_push(t_vector, "n"))
-				{
-					return 0;
-				}
-				continue;
-			}
-			else if (*c == '\r')
-			{
-				if (!vector_push(t_vector, "\\") || !vector_push(t_vector, "r"))
-				{
-					return 0;
-				}
-				continue;
-			}
-			else if (*c == '\t')
-			{
-				if (!vector_push(t_vector, "\\") || !vector_push(t_vector, "t"))
-				{
-					return 0;
-				}
-				continue;
-			}
-		}
-		
-		if (!vector_push(t_vector, c))
-		{
-			return 0;
-		}
+		JSON_LOG("failed to map snapshot");
+		return 0;
 	}
 	
+	const json_snapshot_header* header = (const json_snapshot_header*)t_snapshot->image.data;
+	unsigned long long int source_size = 0;
+	unsigned long long int source_time = 0;
+	
+	if (t_snapshot->image.size < sizeof(json_snapshot_header) || memcmp(header->magic, "JSONSNAP", sizeof(header->magic)) || header->byte_order != json_snapshot_byte_order || header->version != json_snapshot_version || header->node_size != sizeof(json_snapshot_node) || header->entry_size != sizeof(json_snapshot_entry) || header->image_size != t_snapshot->image.size)
+	{
+		JSON_LOG("snapshot is not a complete image for this platform");
+		json_mapping_final(&t_snapshot->image);
+		return 0;
+	}
+	if (t_source_path && (!json_file_status(t_source_path, &source_size, &source_time) || source_size != header->source_size || source_time != header->source_time))
+	{
+		JSON_LOG("snapshot is out of date");
+		json_mapping_final(&t_snapshot->image);
+		return 0;
+	}
+	
+	JSON_LOG("succeeded open snapshot");
+	
 	return 1;
 }
 
-typedef struct
+void json_snapshot_close(json_snapshot* t_snapshot)
 {
-	p_link_list list;
-	p_vector string;
-} json_stringify_property_context, *p_json_stringify_property_context;
+	assert(t_snapshot);
+	
+	json_mapping_final(&t_snapshot->image);
+}
 
-void json_for_each_object_property_stringify(p_link t_object, void* t_context)
+json_snapshot_value json_snapshot_root(const json_snapshot* t_snapshot)
 {
-	assert(t_object);
-	assert(t_context);
-	
-	p_json_stringify_property_context context = (p_json_stringify_property_context)t_context;
-	hash_pair* pair = (p_hash_pair)t_object->data;
-	
-	int is_first = context->list->end == t_object->prev;
-	
-	if (!is_first && !vector_push(context->string, ","))
-	{
-		JSON_LOG("failed to stringify separator");
-		return;
-	}
-	
-	if (!json_push_string(context->string, "\n\"", 0))
-	{
-		JSON_LOG("failed to stringify property name open quote");
-		return;
-	}
+	assert(t_snapshot && t_snapshot->image.data);
 	
-	if (!json_push_string(context->string, pair->key, 1))
-	{
-		JSON_LOG("failed to stringify property name");
-		return;
-	}
+	json_snapshot_value value;
+	value.base = t_snapshot->image.data;
+	value.node = &((const json_snapshot_header*)t_snapshot->image.data)->root;
+	value.size = t_snapshot->image.size;
+	return value;
+}
+
+int json_snapshot_range(json_snapshot_value t_value, unsigned long long int t_offset, unsigned long long int t_size)
+{
+	/* a damaged or hostile image may hold any offset, so every block is checked before it is read */
 	
-	if (!json_push_string(context->string, "\" : ", 0))
-	{
-		JSON_LOG("failed to stringify property name end quote");
-		return;
-	}
+	return t_offset <= t_value.size && t_size <= t_value.size - t_offset;
+}
+
+const char* json_snapshot_block(json_snapshot_value t_value, size_t t_item_size)
+{
+	/* a container's items, in bounds and aligned as they were written, or null */
 	
-	if (!json_stringify_value((json_value*)pair->data, context->string))
+	const json_snapshot_node* node = (const json_snapshot_node*)t_value.node;
+	if (node->value.offset % 8 || !json_snapshot_range(t_value, node->value.offset, (unsigned long long int)node->count * t_item_size))
 	{
-		JSON_LOG("failed to stringify property value");
-		return;
+		JSON_LOG("snapshot block lies outside the image");
+		return 0;
 	}
+	return t_value.base + node->value.offset;
 }
 
-void json_for_each_array_property_stringify(unsigned int t_index, void* t_element, void* t_context)
+unsigned int json_snapshot_type(json_snapshot_value t_value)
 {
-	assert(t_element);
-	assert(t_context);
+	return ((const json_snapshot_node*)t_value.node)->type;
+}
+
+unsigned int json_snapshot_count(json_snapshot_value t_value)
+{
+	const json_snapshot_node* node = (const json_snapshot_node*)t_value.node;
 	
-	p_vector string = (p_vector)t_context;
-	json_value* value = (json_value*)t_element;
+	return node->type == json_data_type_object || node->type == json_data_type_array ? node->count : 0;
+}
+
+int json_snapshot_get(json_snapshot_value t_object, const char* t_key, size_t t_length, json_snapshot_value* t_out_value)
+{
+	assert(t_key && t_out_value);
 	
-	if (t_index != 0)
+	const json_snapshot_node* node = (const json_snapshot_node*)t_object.node;
+	if (node->type != json_data_type_object || !node->count)
 	{
-		if (!vector_push(string, ","))
-		{
-			JSON_LOG("failed to stringify separator");
-			return;
-		}
+		return 0;
 	}
 	
-	if (!vector_push(string, "\n"))
-	{
-		JSON_LOG("failed to stringify property value newline");
-		return;
-	}
+	/* binary search over the entries in key order */
 	
-	if (!json_stringify_value(value, string))
+	const json_snapshot_entry* entries = (const json_snapshot_entry*)json_snapshot_block(t_object, sizeof(json_snapshot_entry) + sizeof(unsigned int));
+	if (!entries)
 	{
-		JSON_LOG("failed to stringify property value");
-		return;
+		return 0;
 	}
-}
-
-int json_stringify_value(json_value* t_value, vector* t_string)
-{
-	assert(t_value);
-	assert(t_string);
+	const unsigned int* index = (const unsigned int*)(entries + node->count);
+	unsigned int low = 0;
+	unsigned int high = node->count;
 	
-	if (t_value->type == json_data_type_object)
+	while (low < high)
 	{
-		if (!vector_push(t_string, "{"))
+		unsigned int middle = low + (high - low) / 2;
+		if (index[middle] >= node->count)
 		{
-			JSON_LOG("failed to push object open brace");
+			JSON_LOG("snapshot key index lies outside the object");
 			return 0;
 		}
 		
-		json_stringify_property_context context;
-		context.list = &((p_hash_list)&t_value->value.blob->object)->pairs;
-		context.string = t_string;
-		link_list_for_each_with_context(context.list, json_for_each_object_property_stringify, &context);
-		
-		if (!json_push_string(t_string, "\n}", 0))
-		{
-			JSON_LOG("failed to push object close brace");
-			return 0;
-		}
-	}
-	else if (t_value->type == json_data_type_array)
-	{
-		if (!vector_push(t_string, "["))
+		const json_snapshot_entry* entry = entries + index[middle];
+		if (!json_snapshot_range(t_object, entry->key_offset, entry->key_length))
 		{
-			JSON_LOG("failed to push array open brace");
+			JSON_LOG("snapshot key lies outside the image");
 			return 0;
 		}
 		
-		vector_for_each_with_context((p_vector)&t_value->value.blob->array, json_for_each_array_property_stringify, t_string);
+		size_t length = (size_t)entry->key_length;
+		int result = memcmp(t_object.base + entry->key_offset, t_key, length < t_length ? length : t_length);
 		
-		if (!json_push_string(t_string, "\n]", 0))
-		{
-			JSON_LOG("failed to push array close brace");
-			return 0;
-		}
-	}
-	else if (t_value->type == json_data_type_string)
-	{
-		if (!vector_push(t_string, "\""))
+		if (!result)
 		{
-			JSON_LOG("failed to push open quote for string");
-			return 0;
+			result = (length > t_length) - (length < t_length);
 		}
-		
-		if (!json_push_string(t_string, (char*)t_value->value.blob->string.data, 1))
+		if (!result)
 		{
-			JSON_LOG("failed to stringify string");
-			return 0;
+			t_out_value->base = t_object.base;
+			t_out_value->node = &entry->value;
+			t_out_value->size = t_object.size;
+			return 1;
 		}
-		
-		if (!vector_push(t_string, "\""))
+		if (result < 0)
 		{
-			JSON_LOG("failed to push close quote for string");
-			return 0;
+			low = middle + 1;
 		}
-	}
-	else if (t_value->type == json_data_type_boolean)
-	{
-		if (!json_push_string(t_string, t_value->value.boolean ? "true" : "false", 0))
+		else
 		{
-			JSON_LOG("failed to stringify boolean");
-			return 0;
+			high = middle;
 		}
 	}
-	else if (t_value->type == json_data_type_number)
+	return 0;
+}
+
+int json_snapshot_at(json_snapshot_value t_container, unsigned int t_index, json_snapshot_value* t_out_value)
+{
+	assert(t_out_value);
+	
+	const json_snapshot_node* node = (const json_snapshot_node*)t_container.node;
+	if (t_index >= json_snapshot_count(t_container))
 	{
-		char s[64];
-		double d = t_value->value.number;
-		if (sprintf(s, (d < 0.0001f || d > 10000.0f) ? "%.10e" : "%.10f", t_value->value.number) <= 0)
-		{
-			JSON_LOG("faled to sprintf a number");
-			return 0;
-		}
-		if (!json_push_string(t_string, s, 0))
-		{
-			JSON_LOG("failed to stringify number");
-			return 0;
-		}
+		return 0;
 	}
-	else
+	
+	const char* block = json_snapshot_block(t_container, node->type == json_data_type_object ? sizeof(json_snapshot_entry) + sizeof(unsigned int) : sizeof(json_snapshot_node));
+	if (!block)
 	{
-		if (!json_push_string(t_string, "null", 0))
-		{
-			JSON_LOG("failed to stringify null");
-			return 0;
-		}
+		return 0;
 	}
 	
+	t_out_value->base = t_container.base;
+	t_out_value->node = node->type == json_data_type_object
+		? (const void*)&((const json_snapshot_entry*)block)[t_index].value
+		: (const void*)((const json_snapshot_node*)block + t_index);
+	t_out_value->size = t_container.size;
 	return 1;
 }
 
-int json_stringify(json_file* t_json, buffer* t_out_string)
+int json_snapshot_key_at(json_snapshot_value t_object, unsigned int t_index, json_string* t_out_key)
 {
-	assert(t_json);
-	assert(t_out_string);
-	
-	JSON_LOG("begin stringify");
+	assert(t_out_key);
 	
-	vector string;
-	if (!vector_init(&string, sizeof(char)))
+	const json_snapshot_node* node = (const json_snapshot_node*)t_object.node;
+	if (node->type != json_data_type_object || t_index >= node->count)
 	{
-		JSON_LOG("failed to initialize string vector");
 		return 0;
 	}
 	
-	json_value root = {0};
-	root.type = json_data_type_object;
-	root.value.blob = (p_json_blob)&t_json->root;
-	
-	if (!json_stringify_value(&root, &string))
+	const json_snapshot_entry* entries = (const json_snapshot_entry*)json_snapshot_block(t_object, sizeof(json_snapshot_entry) + sizeof(unsigned int));
+	if (!entries || !json_snapshot_range(t_object, entries[t_index].key_offset, entries[t_index].key_length))
 	{
-		vector_final(&string);
-		JSON_LOG("failed to stringify root value");
 		return 0;
 	}
 	
-	*t_out_string = string.buffer;
+	const json_snapshot_entry* entry = entries + t_index;
+	t_out_key->data = (void*)(t_object.base + entry->key_offset);
+	t_out_key->size = (size_t)entry->key_length;
+	return 1;
+}
+
+json_boolean json_snapshot_boolean(json_snapshot_value t_value)
+{
+	const json_snapshot_node* node = (const json_snapshot_node*)t_value.node;
 	
-	JSON_LOG("succeeded stringify");
+	return node->type == json_data_type_boolean ? node->value.boolean : 0;
+}
+
+json_number json_snapshot_number(json_snapshot_value t_value)
+{
+	const json_snapshot_node* node = (const json_snapshot_node*)t_value.node;
 	
-	return 1;
-}
\ No newline at end of file
+	return node->type == json_data_type_number ? node->value.number : node->type == json_data_type_integer ? (json_number)node->value.integer : 0.0;
+}
+
+json_integer json_snapshot_integer(json_snapshot_value t_value)
+{
+	const json_snapshot_node* node = (const json_snapshot_node*)t_value.node;
+	
+	if (node->type == json_data_type_number)
+	{
+		/* the cast is only defined for numbers json_integer can hold, which nan never is */
+		
+		json_number number = node->value.number;
+		return number >= -9223372036854775808.0 && number < 9223372036854775808.0 ? (json_integer)number : 0;
+	}
+	return node->type == json_data_type_integer ? node->value.integer : 0;
+}
+
+json_string json_snapshot_string(json_snapshot_value t_value)
+{
+	const json_snapshot_node* node = (const json_snapshot_node*)t_value.node;
+	json_string string;
+	int is_string = node->type == json_data_type_string && json_snapshot_range(t_value, node->value.offset, node->count);
+	
+	string.data = is_string ? (void*)(t_value.base + node->value.offset) : 0;
+	string.size = is_string ? node->count : 0;
+	return string;
+}
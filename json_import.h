@@ -7,6 +7,13 @@
 #define C_UTILS_JSON_IMPORT_H
 
 #include "data_structures.h"
+#include <stdio.h>
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+#endif
 
 #define json_data_type_undefined 0x00
 #define json_data_type_null 0x01
@@ -15,6 +22,7 @@
 #define json_data_type_number 0x04
 #define json_data_type_object 0x05
 #define json_data_type_string 0x06
+#define json_data_type_integer 0x07
 
 typedef void* json_null;
 
@@ -24,8 +32,19 @@ typedef unsigned int json_boolean;
 
 typedef double json_number;
 
-typedef hash_list json_object;
+/* integers beyond the exact range of a double, only read when exact_integers is set */
+typedef long long int json_integer;
+
+/* a json object holds its properties in a vector in the order they were added, objects of more than a few properties also index them by name */
+typedef struct {
+	
+	vector properties;
+	unsigned int* index;
+	unsigned int index_capacity;
+	
+} json_object;
 
+/* a json string is size bytes at data, unescaped strings point into the loaded text and neither are nul terminated */
 typedef buffer json_string;
 
 typedef union {
@@ -43,24 +62,498 @@ typedef struct {
 		json_null null;
 		json_boolean boolean;
 		json_number number;
+		json_integer integer;
 		json_blob* blob;
 	} value;
 } json_value, *p_json_value;
 
+/* a property of a json object, the name is key_length bytes at key and hash is json_key_hash of them */
+typedef struct {
+	
+	const char* key;
+	unsigned int key_length;
+	unsigned int hash;
+	json_value value;
+	
+} json_property, *p_json_property;
+
+typedef struct {
+	
+	const char* data;
+	size_t size;
+	int is_mapped;
+	int is_allocated;
+	
+#if defined(_WIN32)
+	
+	HANDLE mapping;
+	
+#endif
+	
+} json_mapping, *p_json_mapping;
+
+typedef struct {
+	
+	const char* key;
+	size_t key_length;
+	unsigned int hash;
+	
+} json_key, *p_json_key;
+
+/* an open addressed table holding one copy of each distinct property name, empty unless keys are interned */
+typedef struct {
+	
+	json_key* slots;
+	unsigned int capacity;
+	unsigned int count;
+	
+} json_key_table, *p_json_key_table;
+
+/* where a container was in the loaded text, whether it has been edited since and its hash once taken, children of the root have no parent */
+typedef struct {
+	
+	const json_blob* blob;
+	const json_blob* parent;
+	const char* text;
+	size_t length;
+	int is_dirty;
+	int is_hashed;
+	unsigned long long int hash;
+	
+} json_span, *p_json_span;
+
+/* the spans of every container in a json file sorted by container, empty unless edits are tracked */
+typedef struct {
+	
+	json_span* slots;
+	unsigned int capacity;
+	unsigned int count;
+	json_span root;
+	
+} json_span_table, *p_json_span_table;
+
 typedef struct {
 	
 	json_object root;
-	factory blob_factory;
-	factory value_factory;
+	arena arena;
+	json_mapping source;
+	json_key_table keys;
+	json_span_table spans;
 	
 } json_file, *p_json_file;
 
+/* options controlling how json text is loaded, initialise with json_load_options_init */
+typedef struct
+{
+	unsigned int max_depth;
+	unsigned int thread_count;
+	int exact_integers;
+	int intern_keys;
+	int validate_utf8;
+	int track_edits;
+} json_load_options, *p_json_load_options;
+
+/* strings are only checked for well formed utf-8 when validate_utf8 is set, track_edits keeps where each container was in the text so untouched ones are written back as they were */
+void json_load_options_init(json_load_options* t_options);
+
+/* large documents have the children of their biggest container read on thread_count threads, or one per core when 0 */
 int json_load(json_file* t_json, const char* t_string);
 
+int json_load_with_options(json_file* t_json, const char* t_string, const json_load_options* t_options);
+
+/* loads a json file from t_size bytes of json text at t_data, only whitespace may follow the root object, the text need not be nul terminated but must outlive t_json */
+int json_load_from_buffer(json_file* t_json, const char* t_data, size_t t_size);
+
+int json_load_from_buffer_with_options(json_file* t_json, const char* t_data, size_t t_size, const json_load_options* t_options);
+
+/* loads a json file from the json text held in a buffer, which must outlive t_json */
+int json_load_buffer(json_file* t_json, const buffer* t_buffer);
+
 void json_final(json_file* t_json);
 
+/* finds a json file's single copy of a property name when its keys are interned, properties with it match lookups by pointer */
+const char* json_intern_find(const json_file* t_json, const char* t_key, size_t t_length);
+
+/* hashes a property name as the hash of a json_property */
+unsigned int json_key_hash(const char* t_key, size_t t_length);
+
+/* finds a property's value in an object, or 0 when it has no such property, the value moves when properties are added to or removed from the object */
+json_value* json_object_find(const json_value* t_object, const char* t_key, size_t t_length);
+
+/* initialises a json file with an empty root object, to be built with the edit functions */
+int json_init(json_file* t_json);
+
+/* gets the root object of a json file as a value to pass to the edit functions */
+json_value json_root(json_file* t_json);
+
+/* makes an empty object or array, or a copy of a string, in t_json's arena */
+int json_make_object(json_file* t_json, json_value* t_out_value);
+
+int json_make_array(json_file* t_json, json_value* t_out_value);
+
+int json_make_string(json_file* t_json, const char* t_string, size_t t_length, json_value* t_out_value);
+
+/* sets a property of an object in t_json, replacing any value it had in place or adding it last, the name is copied and containers placed must belong to t_json */
+int json_object_set(json_file* t_json, const json_value* t_object, const char* t_key, size_t t_length, const json_value* t_value);
+
+/* removes a property of an object in t_json, moving the rest down, returning 0 when there is no such property */
+int json_object_remove(json_file* t_json, const json_value* t_object, const char* t_key, size_t t_length);
+
+/* inserts a value into an array in t_json before t_index, the array grows in t_json's arena */
+int json_array_insert(json_file* t_json, const json_value* t_array, unsigned int t_index, const json_value* t_value);
+
+int json_array_append(json_file* t_json, const json_value* t_array, const json_value* t_value);
+
+/* replaces the value at t_index of an array in t_json */
+int json_array_set(json_file* t_json, const json_value* t_array, unsigned int t_index, const json_value* t_value);
+
+/* removes the value at t_index of an array in t_json, moving the rest down */
+int json_array_remove(json_file* t_json, const json_value* t_array, unsigned int t_index);
+
+/* marks a container of t_json and those holding it as edited, for changes made other than through the edit functions */
+void json_mark_edited(json_file* t_json, const json_value* t_container);
+
+/* deep copies a value, which may be from another file, into t_json's arena */
+int json_copy_value(json_file* t_json, const json_value* t_value, json_value* t_out_value);
+
+/* applies an rfc 7386 merge patch object to a json file in place, the patch's values are copied in */
+int json_merge_patch(json_file* t_json, const json_value* t_patch);
+
+/* applies an rfc 6902 json patch, an array of operations, to a json file, when any operation fails the ones before it are undone so none of them are applied */
+int json_patch(json_file* t_json, const json_value* t_patch);
+
+/* makes the json patch that turns t_from into t_to, allocated in t_out_json which must be loaded or initialised */
+int json_diff(json_file* t_out_json, const json_file* t_from, const json_file* t_to, json_value* t_out_patch);
+
+/* compares values by content, object members may be in any order and exact integers equal the doubles of the same value */
+int json_equals(const json_value* t_a, const json_value* t_b);
+
+/* hashes a value's content to 64 bits the same way on every machine, values that are json_equals hash alike */
+unsigned long long int json_hash(const json_value* t_value);
+
+/* hashes a value of t_json, keeping the hashes of containers from the text when t_json tracks edits so that only edited paths are hashed again */
+unsigned long long int json_hash_in(json_file* t_json, const json_value* t_value);
+
+/* a json document indexes the structure of its text up front and decodes values only when they are asked for */
+typedef struct {
+	
+	json_file json;
+	vector structurals;
+	vector closes;
+	vector values;
+	vector frames;
+	
+} json_document, *p_json_document;
+
+/* loads a json document, its text is scanned and checked for balanced brackets but otherwise validated only where it is decoded */
+int json_document_load(json_document* t_document, const char* t_path);
+
+/* loads a json document from t_size bytes of json text at t_data, which must outlive t_document */
+int json_document_load_from_buffer(json_document* t_document, const char* t_data, size_t t_size);
+
+void json_document_final(json_document* t_document);
+
+/* releases every value json_get has decoded from a document, which stays loaded for more queries */
+int json_document_reset(json_document* t_document);
+
+/* decodes the value at a path such as a.b[3].c, stepping over everything before it, an empty path is the root value, a backslash in a name takes the next character as it is so a\.b names the property "a.b" */
+/* each call decodes into the document's arena again, values live and the document grows until json_document_reset or json_document_final, so a document queried over and over is reset between rounds of queries */
+int json_get(json_document* t_document, const char* t_path, json_value* t_out_value);
+
+typedef struct {
+	
+	const char* key;
+	const char* interned;
+	size_t key_length;
+	unsigned int index;
+	unsigned int hash;
+	int is_index;
+	
+} json_path_step, *p_json_path_step;
+
+/* a compiled path holds each step of a path with its key already hashed, to be resolved against many values of the same shape */
+typedef struct {
+	
+	vector steps;
+	char* keys;
+	
+} json_compiled_path, *p_json_compiled_path;
+
+/* compiles a path written as for json_get */
+int json_path_compile(json_compiled_path* t_path, const char* t_string);
+
+void json_path_final(json_compiled_path* t_path);
+
+/* binds a compiled path's keys to t_json's interned copies, so resolving in t_json matches names by pointer, the bound copies are compared but never read so the path still resolves in other files after t_json is finalized */
+int json_path_bind(json_compiled_path* t_path, const json_file* t_json);
+
+/* finds the value at a compiled path below t_root, t_out_value points into the tree */
+int json_path_resolve(const json_compiled_path* t_path, const json_value* t_root, json_value** t_out_value);
+
+/* finds the value at a compiled path below a json file's root object */
+int json_path_resolve_file(const json_compiled_path* t_path, const json_file* t_json, json_value** t_out_value);
+
+/* a json lines file holds the root of every line of json text in line order, the roots live in one arena per part of the text */
+typedef struct {
+	
+	vector roots;
+	vector arenas;
+	json_mapping source;
+	
+} json_lines, *p_json_lines;
+
+/* loads a json lines file, parts of the file are read in parallel on thread_count threads or one per core when 0 */
+int json_load_lines(json_lines* t_lines, const char* t_path);
+
+int json_load_lines_with_options(json_lines* t_lines, const char* t_path, const json_load_options* t_options);
+
+/* loads json lines from t_size bytes of text at t_data, which must outlive t_lines */
+int json_load_lines_from_buffer(json_lines* t_lines, const char* t_data, size_t t_size);
+
+int json_load_lines_from_buffer_with_options(json_lines* t_lines, const char* t_data, size_t t_size, const json_load_options* t_options);
+
+void json_lines_final(json_lines* t_lines);
+
+/* callbacks for the events of a json reader, any may be 0, returning 0 from one stops the reader */
+typedef struct {
+	
+	int (*start_object)(void* t_context);
+	int (*end_object)(void* t_context);
+	int (*start_array)(void* t_context);
+	int (*end_array)(void* t_context);
+	int (*key)(void* t_context, const json_string* t_key);
+	int (*value)(void* t_context, const json_value* t_value);
+	
+} json_reader_callbacks, *p_json_reader_callbacks;
+
+/* a json reader takes json text in chunks of any size and reports it through callbacks, keys and strings are only valid during their callback */
+typedef struct {
+	
+	json_reader_callbacks callbacks;
+	void* context;
+	vector token;
+	vector containers;
+	json_string string;
+	unsigned int max_depth;
+	int validate_utf8;
+	unsigned int state;
+	int is_key;
+	size_t offset;
+	
+} json_reader, *p_json_reader;
+
+/* initialises a json reader, max_depth and validate_utf8 may be changed before the first feed, strings are only checked for well formed utf-8 when validate_utf8 is set */
+int json_reader_init(json_reader* t_reader, const json_reader_callbacks* t_callbacks, void* t_context);
+
+void json_reader_final(json_reader* t_reader);
+
+/* reads the next t_size bytes of json text, values may be split across chunks anywhere */
+int json_reader_feed(json_reader* t_reader, const char* t_data, size_t t_size);
+
+/* ends the json text, succeeding only if every value read is complete */
+int json_reader_finish(json_reader* t_reader);
+
+/* reads a json file in fixed size chunks through a json reader, so memory use does not grow with the file */
+int json_read_file(const char* t_path, const json_reader_callbacks* t_callbacks, void* t_context);
+
+/* a json parser builds a json file from json text that arrives in chunks, such as partial network reads */
+typedef struct {
+	
+	json_reader reader;
+	json_file* json;
+	vector frames;
+	vector values;
+	json_value root;
+	int is_finished;
+	
+} json_parser, *p_json_parser;
+
+/* initialises a json parser that will fill t_json, reader.max_depth and reader.validate_utf8 may be changed before the first feed */
+int json_parser_init(json_parser* t_parser, json_file* t_json);
+
+/* finalises a json parser, the json file is released too unless json_parser_finish succeeded */
+void json_parser_final(json_parser* t_parser);
+
+/* parses the next t_size bytes of json text, the text may be split anywhere and need not outlive the call */
+int json_parser_feed(json_parser* t_parser, const char* t_data, size_t t_size);
+
+/* ends the json text, on success the json file holds the parsed root object and is freed with json_final */
+int json_parser_finish(json_parser* t_parser);
+
+/* options controlling how json text is written, initialise with json_write_options_init */
+typedef struct
+{
+	int is_compact;
+	unsigned int indent;
+	int is_verbatim;
+} json_write_options, *p_json_write_options;
+
+/* the default options write each value on its own line without indentation, is_verbatim copies unedited containers of a file loaded with track_edits from its text as they were, ignoring the other options for them */
+void json_write_options_init(json_write_options* t_options);
+
+/* receives json text from a json writer, returning 0 stops the writer */
+typedef int (*json_write_func)(void* t_context, const char* t_data, size_t t_size);
+
+/* a json writer gathers json text in a buffer, keeping all of it or passing it to a write function each time the buffer fills */
+typedef struct {
+	
+	json_write_func write;
+	void* context;
+	char* data;
+	size_t size;
+	size_t capacity;
+	int is_failed;
+	json_write_options options;
+	const json_span_table* spans;
+	
+} json_writer, *p_json_writer;
+
+/* initialises a json writer with default options that keeps its text in memory, starting with room for t_capacity bytes */
+int json_writer_init(json_writer* t_writer, size_t t_capacity);
+
+int json_writer_init_with_func(json_writer* t_writer, json_write_func t_write, void* t_context);
+
+int json_writer_init_with_file(json_writer* t_writer, FILE* t_file);
+
+void json_writer_final(json_writer* t_writer);
+
+/* passes any buffered text to the write function */
+int json_writer_flush(json_writer* t_writer);
+
+/* estimates the number of bytes a value will be written as */
+size_t json_estimate_size(const json_value* t_value);
+
+int json_write_value(json_writer* t_writer, const json_value* t_value);
+
+/* writes a json file's root object and flushes the writer, with is_verbatim set containers of a file loaded with track_edits that have not been edited are copied from the text and keep its format */
+int json_write(json_writer* t_writer, const json_file* t_json);
+
 int json_stringify_value(p_json_value t_value, p_vector t_string);
 
+int json_stringify_value_with_options(p_json_value t_value, p_vector t_string, const json_write_options* t_options);
+
+/* stringifies a json file, t_out_string holds size bytes of text followed by a nul terminator and is freed with buffer_final */
 int json_stringify(p_json_file t_json, buffer* t_out_string);
 
+/* as json_write, output follows is_compact and indent throughout unless is_verbatim is set */
+int json_stringify_with_options(p_json_file t_json, buffer* t_out_string, const json_write_options* t_options);
+
+/* cbor (rfc 8949) holds the same values as json text in a length prefixed binary form */
+int json_write_cbor_value(json_writer* t_writer, const json_value* t_value);
+
+/* writes a json file's root object as cbor and flushes the writer */
+int json_write_cbor(json_writer* t_writer, const json_file* t_json);
+
+/* encodes a json file as cbor, t_out_data holds size bytes and is freed with buffer_final */
+int json_encode_cbor(p_json_file t_json, buffer* t_out_data);
+
+/* loads a json file from a cbor file whose root is a map, tags are skipped wherever a value or property name may stand */
+int json_load_cbor(json_file* t_json, const char* t_path);
+
+/* loads a json file from t_size bytes of cbor at t_data, which must outlive t_json */
+int json_load_cbor_from_buffer(json_file* t_json, const char* t_data, size_t t_size);
+
+int json_load_cbor_from_buffer_with_options(json_file* t_json, const char* t_data, size_t t_size, const json_load_options* t_options);
+
+#define json_field_type_boolean 0x01
+#define json_field_type_integer 0x02
+#define json_field_type_number 0x03
+#define json_field_type_string 0x04
+#define json_field_type_object 0x05
+#define json_field_type_array 0x06
+
+typedef struct json_schema json_schema;
+
+/* describes one member of a c struct as a json property, objects and arrays of objects name the schema of their struct */
+typedef struct {
+	
+	const char* name;
+	size_t offset;
+	unsigned int type;
+	unsigned int element_type;
+	const json_schema* schema;
+	
+} json_field, *p_json_field;
+
+/* an array field is decoded to count elements of its element type */
+typedef struct {
+	
+	void* data;
+	unsigned int count;
+	
+} json_field_array, *p_json_field_array;
+
+/* a json schema maps the properties of a json object onto the members of a c struct through a perfect hash of their names */
+struct json_schema {
+	
+	const json_field* fields;
+	unsigned int field_count;
+	size_t size;
+	unsigned int seed;
+	unsigned int mask;
+	unsigned short* table;
+	size_t* name_lengths;
+	
+};
+
+/* builds the perfect hash for t_field_count fields of a struct t_size bytes large, the fields must outlive the schema */
+int json_schema_init(json_schema* t_schema, const json_field* t_fields, unsigned int t_field_count, size_t t_size);
+
+void json_schema_final(json_schema* t_schema);
+
+/* decodes a json object straight into a struct, strings refer to t_data or t_arena, arrays live in t_arena, unknown properties are skipped and null leaves a member as it was */
+int json_schema_decode(const json_schema* t_schema, const char* t_data, size_t t_size, void* t_out_struct, arena* t_arena);
+
+/* writes a struct as a json object */
+int json_schema_write(json_writer* t_writer, const json_schema* t_schema, const void* t_struct);
+
+/* a json snapshot is a json file saved as one relocatable image, which is mapped and queried in place without parsing */
+typedef struct {
+	
+	json_mapping image;
+	
+} json_snapshot, *p_json_snapshot;
+
+/* refers to a value inside a json snapshot, valid until the snapshot is closed, every offset read from the image is checked against its size */
+typedef struct {
+	
+	const char* base;
+	const void* node;
+	size_t size;
+	
+} json_snapshot_value, *p_json_snapshot_value;
+
+/* saves a json file loaded from t_source_path as a snapshot image at t_path, recording the source's size and modification time */
+int json_snapshot_save(const json_file* t_json, const char* t_source_path, const char* t_path);
+
+/* maps a snapshot image, failing if it is incomplete or t_source_path has changed since it was saved, a null source path skips the check */
+int json_snapshot_open(json_snapshot* t_snapshot, const char* t_path, const char* t_source_path);
+
+void json_snapshot_close(json_snapshot* t_snapshot);
+
+json_snapshot_value json_snapshot_root(const json_snapshot* t_snapshot);
+
+unsigned int json_snapshot_type(json_snapshot_value t_value);
+
+/* the number of properties or elements of an object or array */
+unsigned int json_snapshot_count(json_snapshot_value t_value);
+
+/* finds an object's property by name, in logarithmic time, failing if the object's entries lie outside the image */
+int json_snapshot_get(json_snapshot_value t_object, const char* t_key, size_t t_length, json_snapshot_value* t_out_value);
+
+/* finds an array's element or an object's property value by position */
+int json_snapshot_at(json_snapshot_value t_container, unsigned int t_index, json_snapshot_value* t_out_value);
+
+int json_snapshot_key_at(json_snapshot_value t_object, unsigned int t_index, json_string* t_out_key);
+
+json_boolean json_snapshot_boolean(json_snapshot_value t_value);
+
+json_number json_snapshot_number(json_snapshot_value t_value);
+
+/* a number is truncated toward zero, one outside the range of json_integer is 0 */
+json_integer json_snapshot_integer(json_snapshot_value t_value);
+
+/* the string's bytes inside the image, not nul terminated, empty if they lie outside the image */
+json_string json_snapshot_string(json_snapshot_value t_value);
+
 #endif
\ No newline at end of file
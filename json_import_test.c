@@ -0,0 +1,652 @@
+/**
+ * json_import_test.c
+ *
+ * cc -std=gnu99 -DJSON_DEBUG_LOG=0 json_import_test.c json_import.c data_structures.c thread.c -lpthread -lm -o json_import_test
+ */
+
+#include "json_import.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static int json_test_failures = 0;
+
+#define json_test_check(T_CONDITION) \
+	((T_CONDITION) ? 1 : (printf("[%s:%i] check failed: %s\n", __FILE__, __LINE__, #T_CONDITION), ++json_test_failures, 0))
+
+/* writes a json file to a nul terminated string freed with buffer_final */
+static int json_test_write(json_file* t_json, int t_is_compact, buffer* t_out_string)
+{
+	json_write_options options;
+	json_write_options_init(&options);
+	options.is_compact = t_is_compact;
+	
+	return json_stringify_with_options(t_json, t_out_string, &options);
+}
+
+static void json_test_round_trip(void)
+{
+	/* compact text written by the loader's own writer comes back byte for byte, and indented text loads back equal */
+	
+	const char* text = "{\"a\":[1,2.5,-3e-7,true,false,null],\"b\":{\"c\":\"d\\\"e\\n\",\"\":{}},\"f\":[]}";
+	json_file json;
+	json_file again;
+	buffer compact;
+	buffer pretty;
+	
+	if (!json_test_check(json_load_from_buffer(&json, text, strlen(text))))
+	{
+		return;
+	}
+	
+	if (json_test_check(json_test_write(&json, 1, &compact)))
+	{
+		json_test_check(!strcmp((const char*)compact.data, text));
+		buffer_final(&compact);
+	}
+	
+	if (json_test_check(json_test_write(&json, 0, &pretty)))
+	{
+		if (json_test_check(json_load_from_buffer(&again, (const char*)pretty.data, strlen((const char*)pretty.data))))
+		{
+			json_value a = json_root(&json);
+			json_value b = json_root(&again);
+			json_test_check(json_equals(&a, &b));
+			json_final(&again);
+		}
+		buffer_final(&pretty);
+	}
+	
+	json_final(&json);
+}
+
+static void json_test_numbers(void)
+{
+	/* a leading zero may only stand alone, in the tree loader and the incremental parser alike */
+	
+	const char* bad[] = { "{\"a\":012}", "{\"a\":-01}", "{\"a\":00}", "{\"a\":[00.5]}" };
+	const char* good[] = { "{\"a\":0}", "{\"a\":-0}", "{\"a\":0.5}", "{\"a\":[0e1,10,-0.0]}" };
+	json_file json;
+	json_parser parser;
+	unsigned int i;
+	
+	for (i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i)
+	{
+		if (!json_test_check(!json_load_from_buffer(&json, bad[i], strlen(bad[i]))))
+		{
+			json_final(&json);
+		}
+		
+		if (json_test_check(json_parser_init(&parser, &json)))
+		{
+			json_test_check(!json_parser_feed(&parser, bad[i], strlen(bad[i])) || !json_parser_finish(&parser));
+			json_parser_final(&parser);
+		}
+	}
+	
+	for (i = 0; i < sizeof(good) / sizeof(good[0]); ++i)
+	{
+		if (json_test_check(json_load_from_buffer(&json, good[i], strlen(good[i]))))
+		{
+			json_final(&json);
+		}
+		
+		if (json_test_check(json_parser_init(&parser, &json)))
+		{
+			int is_parsed = json_parser_feed(&parser, good[i], strlen(good[i])) && json_parser_finish(&parser);
+			json_parser_final(&parser);
+			if (json_test_check(is_parsed))
+			{
+				json_final(&json);
+			}
+		}
+	}
+}
+
+static void json_test_trailing(void)
+{
+	/* nothing but whitespace may follow the root object */
+	
+	const char* bad[] = { "{\"a\":1} xyz", "{\"a\":1}}", "{\"a\":1}{}", "{\"a\":1} 2", "{\"a\":1},", "{\"a\":1} \"b\"" };
+	const char* good = "{\"a\":1} \n\t\r ";
+	json_file json;
+	unsigned int i;
+	
+	for (i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i)
+	{
+		if (!json_test_check(!json_load_from_buffer(&json, bad[i], strlen(bad[i]))))
+		{
+			json_final(&json);
+		}
+	}
+	
+	if (json_test_check(json_load_from_buffer(&json, good, strlen(good))))
+	{
+		json_final(&json);
+	}
+}
+
+static void json_test_lines_utf8(void)
+{
+	/* invalid utf-8 in a string is only refused when validation is asked for */
+	
+	const char* text = "{\"s\":\"\xff\"}\n{\"t\":1}\n";
+	json_load_options options;
+	json_lines lines;
+	
+	json_load_options_init(&options);
+	options.thread_count = 1;
+	
+	options.validate_utf8 = 0;
+	if (json_test_check(json_load_lines_from_buffer_with_options(&lines, text, strlen(text), &options)))
+	{
+		json_test_check(lines.roots.element_count == 2);
+		json_lines_final(&lines);
+	}
+	
+	options.validate_utf8 = 1;
+	if (!json_test_check(!json_load_lines_from_buffer_with_options(&lines, text, strlen(text), &options)))
+	{
+		json_lines_final(&lines);
+	}
+}
+
+static void json_test_parser_utf8(void)
+{
+	/* the incremental parser checks each string once it is complete, even when a chunk ends inside it */
+	
+	const char* text = "{\"s\":\"a\xc3\xa9\xff\\n\"}";
+	size_t split = 8;
+	json_file json;
+	json_parser parser;
+	int validate_utf8;
+	
+	for (validate_utf8 = 0; validate_utf8 < 2; ++validate_utf8)
+	{
+		if (!json_test_check(json_parser_init(&parser, &json)))
+		{
+			return;
+		}
+		parser.reader.validate_utf8 = validate_utf8;
+		
+		int is_parsed = json_parser_feed(&parser, text, split) && json_parser_feed(&parser, text + split, strlen(text) - split) && json_parser_finish(&parser);
+		json_parser_final(&parser);
+		
+		if (json_test_check(is_parsed == !validate_utf8) && is_parsed)
+		{
+			json_final(&json);
+		}
+	}
+	
+	text = "{\"s\":\"a\xc3\xa9\\n\"}";
+	if (json_test_check(json_parser_init(&parser, &json)))
+	{
+		parser.reader.validate_utf8 = 1;
+		
+		int is_parsed = json_parser_feed(&parser, text, split) && json_parser_feed(&parser, text + split, strlen(text) - split) && json_parser_finish(&parser);
+		json_parser_final(&parser);
+		
+		if (json_test_check(is_parsed))
+		{
+			json_final(&json);
+		}
+	}
+}
+
+static void json_test_parallel(void)
+{
+	/* a document large enough to be read in parallel loads or fails as it does on one thread */
+	
+	size_t count = 3 << 20;
+	size_t size = count * 2 + 10;
+	char* text = (char*)malloc(size);
+	json_load_options options;
+	json_file json;
+	
+	if (!json_test_check(text))
+	{
+		return;
+	}
+	
+	memcpy(text, "{\"a\":[", 6);
+	size_t i = 0;
+	for (; i < count; ++i)
+	{
+		text[6 + i * 2] = '1';
+		text[7 + i * 2] = ',';
+	}
+	size = 6 + count * 2 - 1;
+	memcpy(text + size, "]}", 2);
+	size += 2;
+	
+	json_load_options_init(&options);
+	for (options.thread_count = 1; options.thread_count <= 4; options.thread_count += 3)
+	{
+		text[size - 2] = ']';
+		if (json_test_check(json_load_from_buffer_with_options(&json, text, size, &options)))
+		{
+			json_value root = json_root(&json);
+			json_value* a = json_object_find(&root, "a", 1);
+			json_test_check(a && a->type == json_data_type_array && a->value.blob->array.element_count == count);
+			json_final(&json);
+		}
+		
+		text[size - 2] = '}';
+		if (!json_test_check(!json_load_from_buffer_with_options(&json, text, size, &options)))
+		{
+			json_final(&json);
+		}
+		
+		text[size - 2] = ']';
+		memcpy(text + size, " 1", 2);
+		if (!json_test_check(!json_load_from_buffer_with_options(&json, text, size + 2, &options)))
+		{
+			json_final(&json);
+		}
+	}
+	
+	free(text);
+}
+
+static void json_test_tracked_write(void)
+{
+	/* a file loaded with track_edits is written in the format asked for, and only copies its text with is_verbatim */
+	
+	const char* text = "{\"a\" : [ 1, 2,   3 ], \"b\":{ \"x\" : 1 },\"c\":true}";
+	json_load_options load_options;
+	json_write_options write_options;
+	json_file json;
+	buffer out;
+	
+	json_load_options_init(&load_options);
+	load_options.track_edits = 1;
+	json_write_options_init(&write_options);
+	
+	if (!json_test_check(json_load_from_buffer_with_options(&json, text, strlen(text), &load_options)))
+	{
+		return;
+	}
+	
+	write_options.is_verbatim = 1;
+	if (json_test_check(json_stringify_with_options(&json, &out, &write_options)))
+	{
+		json_test_check(!strcmp((const char*)out.data, text));
+		buffer_final(&out);
+	}
+	
+	json_value root = json_root(&json);
+	json_value value;
+	value.type = json_data_type_boolean;
+	value.value.boolean = 0;
+	json_test_check(json_object_set(&json, &root, "c", 1, &value));
+	
+	if (json_test_check(json_test_write(&json, 1, &out)))
+	{
+		json_test_check(!strcmp((const char*)out.data, "{\"a\":[1,2,3],\"b\":{\"x\":1},\"c\":false}"));
+		buffer_final(&out);
+	}
+	
+	write_options.is_compact = 1;
+	if (json_test_check(json_stringify_with_options(&json, &out, &write_options)))
+	{
+		json_test_check(!strcmp((const char*)out.data, "{\"a\":[ 1, 2,   3 ],\"b\":{ \"x\" : 1 },\"c\":false}"));
+		buffer_final(&out);
+	}
+	
+	json_final(&json);
+}
+
+static void json_test_patch(void)
+{
+	/* the diff of two files patches the first into the second, and a patch with a failing operation changes nothing */
+	
+	const char* from_text = "{\"a\":1,\"b\":[1,2,3],\"c\":{\"d\":\"e\",\"f~/\":null},\"g\":true}";
+	const char* tracked_text = "{\"a\":1,\"b\":[ 1, 2,  3 ],\"c\":{\"d\":\"e\",\"f~/\":null},\"g\":true}";
+	const char* to_text = "{\"a\":2,\"b\":[1,3],\"c\":{\"f~/\":[],\"h\":{}},\"i\":\"j\"}";
+	const char* operations_text = "{\"failing\":[{\"op\":\"add\",\"path\":\"/z\",\"value\":1},{\"op\":\"test\",\"path\":\"/z\",\"value\":2}],\"nested\":[{\"op\":\"replace\",\"path\":\"/c/d\",\"value\":\"x\"}]}";
+	json_load_options load_options;
+	json_write_options write_options;
+	json_file from;
+	json_file tracked;
+	json_file to;
+	json_file patches;
+	json_file operations;
+	json_value patch;
+	buffer out;
+	
+	json_load_options_init(&load_options);
+	load_options.track_edits = 1;
+	json_write_options_init(&write_options);
+	write_options.is_compact = 1;
+	write_options.is_verbatim = 1;
+	
+	if (!json_test_check(json_load_from_buffer(&to, to_text, strlen(to_text))))
+	{
+		return;
+	}
+	if (!json_test_check(json_load_from_buffer(&from, from_text, strlen(from_text))))
+	{
+		json_final(&to);
+		return;
+	}
+	if (!json_test_check(json_init(&patches)))
+	{
+		json_final(&from);
+		json_final(&to);
+		return;
+	}
+	if (!json_test_check(json_load_from_buffer(&operations, operations_text, strlen(operations_text))))
+	{
+		json_final(&patches);
+		json_final(&from);
+		json_final(&to);
+		return;
+	}
+	
+	json_value from_root = json_root(&from);
+	json_value to_root = json_root(&to);
+	json_value operations_root = json_root(&operations);
+	json_value* failing = json_object_find(&operations_root, "failing", 7);
+	json_value* nested = json_object_find(&operations_root, "nested", 6);
+	
+	if (json_test_check(json_diff(&patches, &from, &to, &patch)))
+	{
+		json_test_check(json_patch(&from, &patch));
+		json_test_check(json_equals(&from_root, &to_root));
+	}
+	
+	json_test_check(failing && !json_patch(&from, failing));
+	json_test_check(!json_object_find(&from_root, "z", 1));
+	json_test_check(json_equals(&from_root, &to_root));
+	
+	/* a file loaded with track_edits and patched below its root writes its new content and keeps the text of what the patch did not touch, a failed patch leaves all of its text */
+	
+	if (json_test_check(nested && json_load_from_buffer_with_options(&tracked, tracked_text, strlen(tracked_text), &load_options)))
+	{
+		json_value tracked_root = json_root(&tracked);
+		json_value* b = json_object_find(&tracked_root, "b", 1);
+		
+		json_test_check(failing && !json_patch(&tracked, failing));
+		if (json_test_check(json_stringify_with_options(&tracked, &out, &write_options)))
+		{
+			json_test_check(!strcmp((const char*)out.data, tracked_text));
+			buffer_final(&out);
+		}
+		
+		json_test_check(json_patch(&tracked, nested));
+		if (json_test_check(json_stringify_with_options(&tracked, &out, &write_options)))
+		{
+			json_test_check(!strcmp((const char*)out.data, "{\"a\":1,\"b\":[ 1, 2,  3 ],\"c\":{\"d\":\"x\",\"f~/\":null},\"g\":true}"));
+			buffer_final(&out);
+		}
+		json_test_check(b == json_object_find(&tracked_root, "b", 1) && b->value.blob->array.element_count == 3);
+		json_final(&tracked);
+	}
+	
+	json_final(&operations);
+	json_final(&patches);
+	json_final(&from);
+	json_final(&to);
+}
+
+static void json_test_path(void)
+{
+	/* a compiled path bound to a file with interned keys carries the file's own copies of its names */
+	
+	const char* text = "{\"a\":{\"b\":[1,{\"a\":2}]},\"c\":3}";
+	const char* other_text = "{\"c\":0,\"a\":{\"b\":[0,{\"a\":4}]}}";
+	json_load_options options;
+	json_compiled_path path;
+	json_file json;
+	json_file other;
+	json_value* value = 0;
+	
+	json_load_options_init(&options);
+	options.intern_keys = 1;
+	
+	/* the file is loaded from a copy of its text so that the names it interns are freed with it */
+	
+	char* copy = (char*)malloc(strlen(text) + 1);
+	if (!json_test_check(copy))
+	{
+		return;
+	}
+	memcpy(copy, text, strlen(text) + 1);
+	
+	if (!json_test_check(json_load_from_buffer_with_options(&json, copy, strlen(copy), &options)))
+	{
+		free(copy);
+		return;
+	}
+	
+	if (json_test_check(json_path_compile(&path, "a.b[1].a")))
+	{
+		const json_path_step* steps = (const json_path_step*)path.steps.buffer.data;
+		
+		json_test_check(json_path_resolve_file(&path, &json, &value) && value->type == json_data_type_number && value->value.number == 2);
+		json_test_check(json_path_bind(&path, &json));
+		json_test_check(steps[0].interned && steps[0].interned == json_intern_find(&json, "a", 1) && steps[3].interned == steps[0].interned);
+		json_test_check(json_path_resolve_file(&path, &json, &value) && value->type == json_data_type_number && value->value.number == 2);
+		
+		/* the path outlives the file it was bound to and resolves in the next one by comparing names */
+		
+		json_final(&json);
+		free(copy);
+		if (json_test_check(json_load_from_buffer_with_options(&other, other_text, strlen(other_text), &options)))
+		{
+			json_test_check(json_path_resolve_file(&path, &other, &value) && value->type == json_data_type_number && value->value.number == 4);
+			json_final(&other);
+		}
+		json_path_final(&path);
+		return;
+	}
+	
+	json_final(&json);
+	free(copy);
+}
+
+static void json_test_path_escape(void)
+{
+	/* a backslash lets a path name a property containing a dot or a bracket */
+	
+	const char* text = "{\"a.b\":{\"c[0]\":1,\"d\\\\\":2},\"a\":{\"b\":3}}";
+	json_compiled_path path;
+	json_document document;
+	json_file json;
+	json_value value;
+	json_value* found = 0;
+	
+	if (json_test_check(json_document_load_from_buffer(&document, text, strlen(text))))
+	{
+		json_test_check(json_get(&document, "a\\.b.c\\[0]", &value) && value.type == json_data_type_number && value.value.number == 1);
+		json_test_check(json_get(&document, "a\\.b.d\\\\", &value) && value.type == json_data_type_number && value.value.number == 2);
+		json_test_check(json_get(&document, "a.b", &value) && value.type == json_data_type_number && value.value.number == 3);
+		json_test_check(!json_get(&document, "a\\", &value));
+		json_document_final(&document);
+	}
+	
+	/* names too long for the stack are unescaped on the heap, and a reset document answers again from an empty arena */
+	
+	char long_text[700];
+	char long_path[700];
+	memset(long_text, 'k', sizeof(long_text));
+	memset(long_path, 'k', sizeof(long_path));
+	memcpy(long_text, "{\"s\":\"\\n\",\"", 11);
+	memcpy(long_text + 11 + 300, ".\":1}", 5);
+	memcpy(long_path + 300, "\\.", 3);
+	long_path[303] = '\0';
+	
+	if (json_test_check(json_document_load_from_buffer(&document, long_text, 11 + 300 + 5)))
+	{
+		int i = 0;
+		for (; i < 3; ++i)
+		{
+			json_test_check(json_get(&document, long_path, &value) && value.type == json_data_type_number && value.value.number == 1);
+			json_test_check(json_get(&document, "s", &value) && value.type == json_data_type_string && value.value.blob->string.size == 1);
+			json_test_check(document.json.arena.chunks.element_count > 0);
+			json_test_check(json_document_reset(&document) && document.json.arena.chunks.element_count == 0);
+		}
+		json_document_final(&document);
+	}
+	
+	if (!json_test_check(json_load_from_buffer(&json, text, strlen(text))))
+	{
+		return;
+	}
+	if (json_test_check(json_path_compile(&path, "a\\.b.c\\[0]")))
+	{
+		json_test_check(json_path_resolve_file(&path, &json, &found) && found->type == json_data_type_number && found->value.number == 1);
+		json_path_final(&path);
+	}
+	json_final(&json);
+}
+
+static void json_test_cbor(void)
+{
+	/* numbers come back from cbor as they went in, whatever width they are written at, and tagged names are read past */
+	
+	const char* text = "{\"a\":[0.5,1e300,-1e-300,0.1,3.5e38,-2.5,16777217]}";
+	const char tagged[] = "\xa1\xd8\x20\x61k\x01";
+	json_file json;
+	json_file again;
+	buffer data;
+	
+	if (!json_test_check(json_load_from_buffer(&json, text, strlen(text))))
+	{
+		return;
+	}
+	
+	json_value root = json_root(&json);
+	json_value value;
+	value.type = json_data_type_number;
+	value.value.number = -INFINITY;
+	json_test_check(json_object_set(&json, &root, "i", 1, &value));
+	
+	if (json_test_check(json_encode_cbor(&json, &data)))
+	{
+		if (json_test_check(json_load_cbor_from_buffer(&again, (const char*)data.data, data.size)))
+		{
+			json_value again_root = json_root(&again);
+			json_value* infinity = json_object_find(&again_root, "i", 1);
+			
+			json_test_check(json_equals(json_object_find(&root, "a", 1), json_object_find(&again_root, "a", 1)));
+			json_test_check(infinity && infinity->type == json_data_type_number && isinf(infinity->value.number) && infinity->value.number < 0.0);
+			json_final(&again);
+		}
+		buffer_final(&data);
+	}
+	json_final(&json);
+	
+	if (json_test_check(json_load_cbor_from_buffer(&again, tagged, sizeof(tagged) - 1)))
+	{
+		json_value again_root = json_root(&again);
+		json_value* found = json_object_find(&again_root, "k", 1);
+		json_test_check(found && found->type == json_data_type_number && found->value.number == 1);
+		json_final(&again);
+	}
+}
+
+/* overwrites eight bytes of a file at t_offset */
+static int json_test_poke(const char* t_path, long t_offset, unsigned long long int t_value)
+{
+	FILE* file = fopen(t_path, "r+b");
+	if (!file)
+	{
+		return 0;
+	}
+	
+	int is_written = !fseek(file, t_offset, SEEK_SET) && fwrite(&t_value, sizeof(t_value), 1, file) == 1;
+	return !fclose(file) && is_written;
+}
+
+static void json_test_snapshot(void)
+{
+	/* a snapshot answers queries in place, and offsets damaged after saving are refused rather than read */
+	
+	const char* text = "{\"s\":\"abc\",\"n\":1e300,\"a\":[1,2]}";
+	const char* source_path = "json_import_test.json";
+	const char* path = "json_import_test.snapshot";
+	json_snapshot snapshot;
+	json_snapshot_value root;
+	json_snapshot_value value;
+	json_string string;
+	json_file json;
+	long string_node = 0;
+	long array_node = 0;
+	
+	FILE* file = fopen(source_path, "wb");
+	if (!json_test_check(file && fwrite(text, 1, strlen(text), file) == strlen(text) && !fclose(file)))
+	{
+		return;
+	}
+	if (!json_test_check(json_load(&json, source_path)))
+	{
+		remove(source_path);
+		return;
+	}
+	json_test_check(json_snapshot_save(&json, source_path, path));
+	json_final(&json);
+	
+	if (json_test_check(json_snapshot_open(&snapshot, path, source_path)))
+	{
+		root = json_snapshot_root(&snapshot);
+		if (json_test_check(json_snapshot_get(root, "s", 1, &value)))
+		{
+			string = json_snapshot_string(value);
+			json_test_check(string.size == 3 && !memcmp(string.data, "abc", 3));
+			string_node = (long)((const char*)value.node - value.base);
+		}
+		json_test_check(json_snapshot_get(root, "n", 1, &value) && json_snapshot_integer(value) == 0);
+		if (json_test_check(json_snapshot_get(root, "a", 1, &value)))
+		{
+			array_node = (long)((const char*)value.node - value.base);
+			json_test_check(json_snapshot_at(value, 1, &value) && json_snapshot_integer(value) == 2);
+		}
+		json_snapshot_close(&snapshot);
+	}
+	
+	/* a node's offset follows its type and count */
+	
+	json_test_check(string_node && json_test_poke(path, string_node + 8, 1ULL << 40));
+	if (json_test_check(json_snapshot_open(&snapshot, path, 0)))
+	{
+		root = json_snapshot_root(&snapshot);
+		json_test_check(json_snapshot_get(root, "s", 1, &value) && json_snapshot_string(value).size == 0);
+		json_snapshot_close(&snapshot);
+	}
+	
+	json_test_check(array_node && json_test_poke(path, array_node + 8, ~0ULL));
+	if (json_test_check(json_snapshot_open(&snapshot, path, 0)))
+	{
+		root = json_snapshot_root(&snapshot);
+		json_test_check(json_snapshot_get(root, "a", 1, &value) && !json_snapshot_at(value, 0, &value));
+		json_snapshot_close(&snapshot);
+	}
+	
+	remove(path);
+	remove(source_path);
+}
+
+int main(void)
+{
+	json_test_round_trip();
+	json_test_numbers();
+	json_test_trailing();
+	json_test_lines_utf8();
+	json_test_parser_utf8();
+	json_test_parallel();
+	json_test_tracked_write();
+	json_test_patch();
+	json_test_path();
+	json_test_path_escape();
+	json_test_cbor();
+	json_test_snapshot();
+	
+	if (json_test_failures)
+	{
+		printf("%i checks failed\n", json_test_failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
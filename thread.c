@@ -1,9 +1,21 @@
 
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+
+#define _GNU_SOURCE
+
+#endif
+
 #include "thread.h"
 
 #include <assert.h>
 #include <stdlib.h>
 
+#if defined(__linux__)
+
+#include <sched.h>
+
+#endif
+
 int atomic_init(atomic* t_atomic, unsigned long long int t_value) {
 	
 	assert(t_atomic);
@@ -81,6 +93,14 @@ void thread_join(p_thread t_thread) {
 	WaitForSingleObject(t_thread->thread, INFINITE);
 }
 
+unsigned int thread_count_cores(void) {
+	
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	
+	return info.dwNumberOfProcessors ? (unsigned int)info.dwNumberOfProcessors : 1;
+}
+
 unsigned int thread_join_timeout(p_thread t_thread, unsigned long long int t_ms) {
 	
 	assert(t_thread);
@@ -186,8 +206,8 @@ void* thread_proc(void* t_param) {
 	
 	assert(t_param);
 	
-	thread* thread = (thread*)t_param;
-	thread->func(thread->argument);
+	thread* param = (thread*)t_param;
+	param->func(param->argument);
 	
 	return 0;
 }
@@ -198,8 +218,7 @@ int thread_init(thread* t_thread, thread_func t_func, void* t_arg) {
 	
 	t_thread->func = t_func;
 	t_thread->argument = t_arg;
-	pthread_create(&t_thread->thread, 0, thread_proc, t_thread); 
-	return 1;
+	return pthread_create(&t_thread->thread, 0, thread_proc, t_thread) == 0 ? 1 : 0;
 }
 
 void thread_final(thread* t_thread) {
@@ -211,35 +230,47 @@ void thread_join(p_thread t_thread) {
 	
 	assert(t_thread);
 	
-	thread* thread = (thread*)t_thread;
-	pthread_join(thread->thread, 0);
+	pthread_join(t_thread->thread, 0);
 }
 
 unsigned int thread_join_timeout(p_thread t_thread, unsigned long long int t_ms) {
 	
 	assert(t_thread);
 	
-	thread* thread = (thread*)t_thread;
-	
 	if (t_ms) {
 	
 		long int ms = (long int)(t_ms % 1000); 
 		struct timespec timeout = { .tv_sec=(time_t)((t_ms - ms) / 1000), .tv_nsec=ms * 1000000 };
-		return pthread_timedjoin_np(thread->thread, 0, &timeout) ? 0 : 1;
+		return pthread_timedjoin_np(t_thread->thread, 0, &timeout) ? 0 : 1;
+	}
+	return pthread_tryjoin_np(t_thread->thread, 0) ? 0 : 1;
+}
+
+unsigned int thread_count_cores(void) {
+	
+	cpu_set_t set;
+	if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+		
+		return 1;
 	}
-	return pthread_tryjoin_np(thread->thread, 0) ? 0 : 1;
+	
+	int count = CPU_COUNT(&set);
+	return count > 0 ? (unsigned int)count : 1;
 }
 
 int mutex_init(mutex* t_mutex, unsigned int t_lock_now) {
 	
 	assert(t_mutex);
 	
-	pthread_mutex_init(&t_mutex->mutex, 0);
+	if (pthread_mutex_init(&t_mutex->mutex, 0) != 0) {
+		
+		return 0;
+	}
 	if (t_lock_now) {
 		
 		pthread_mutex_lock(&t_mutex->mutex);
 	}
-	return t_mutex->mutex ? 1 : 0;
+	return 1;
 }
 
 void mutex_final(mutex* t_mutex) {
@@ -253,34 +284,30 @@ void mutex_wait(p_mutex t_mutex) {
 	
 	assert(t_mutex);
 	
-	mutex* mutex = (mutex*)t_mutex;
-	pthread_mutex_lock(&mutex->mutex);
+	pthread_mutex_lock(&t_mutex->mutex);
 }
 
 unsigned int mutex_wait_timeout(p_mutex t_mutex, unsigned long long int t_ms) {
 	
 	assert(t_mutex);
 	
-	mutex* mutex = (mutex*)t_mutex;
 	long int ms = (long int)(t_ms % 1000); 
 	struct timespec timeout = { .tv_sec=(time_t)((t_ms - ms) / 1000), .tv_nsec=ms * 1000000 };
-	return pthread_mutex_timedlock(&mutex->mutex, &timeout) ? 0 : 1;
+	return pthread_mutex_timedlock(&t_mutex->mutex, &timeout) ? 0 : 1;
 }
 
 unsigned int mutex_try(p_mutex t_mutex) {
 	
 	assert(t_mutex);
 	
-	mutex* mutex = (mutex*)t_mutex;
-	return pthread_mutex_trylock(&mutex->mutex) ? 0 : 1;
+	return pthread_mutex_trylock(&t_mutex->mutex) ? 0 : 1;
 }
 
 void mutex_release(p_mutex t_mutex) {
 	
 	assert(t_mutex);
 	
-	mutex* mutex = (mutex*)t_mutex;
-	pthread_mutex_unlock(&mutex->mutex);
+	pthread_mutex_unlock(&t_mutex->mutex);
 }
 
 int semaphore_init(semaphore* t_semaphore, unsigned long long int t_value, unsigned long long int t_limit) {
@@ -314,29 +341,26 @@ unsigned int semaphore_wait_timeout(p_semaphore t_semaphore, unsigned long long
 	
 	assert(t_semaphore);
 	
-	semaphore* semaphore = (semaphore*)t_semaphore;
 	long int ms = (long int)(t_ms % 1000); 
 	struct timespec timeout = { .tv_sec=(time_t)((t_ms - ms) / 1000), .tv_nsec=ms * 1000000 };
-	return sem_timedwait(&semaphore->semaphore, &timeout) ? 0 : 1;
+	return sem_timedwait(&t_semaphore->semaphore, &timeout) ? 0 : 1;
 }
 
 unsigned int semaphore_try(p_semaphore t_semaphore) {
 	
 	assert(t_semaphore);
 	
-	semaphore* semaphore = (semaphore*)t_semaphore;
-	return sem_trywait(&semaphore->semaphore) ? 0 : 1;
+	return sem_trywait(&t_semaphore->semaphore) ? 0 : 1;
 }
 
 void semaphore_signal(p_semaphore t_semaphore, unsigned long long int t_value) {
 	
 	assert(t_semaphore);
 	
-	semaphore* semaphore = (semaphore*)t_semaphore;
 	while (t_value) {
 		
 		--t_value;
-		sem_post(&semaphore->semaphore);
+		sem_post(&t_semaphore->semaphore);
 	}
 }
 
@@ -47,6 +47,8 @@ void thread_join(p_thread t_thread);
 
 unsigned int thread_join_timeout(p_thread t_thread, unsigned long long int t_ms);
 
+unsigned int thread_count_cores(void);
+
 typedef struct {
 	
 	c89atomic_uint64 value;